@@ -41,6 +41,20 @@ namespace boost
 	BOOST_INSTALL_PROPERTY(edge, properties);
 }
 
+/* the boost::graph edge property of a BoostGraph. A BoostGraph<NODEPROPERTIES, no_property>
+   is the unweighted specialization: its edges carry no property at all, so every edge record
+   is just the two endpoints and there is no property map to go through. Links are added with
+   AddLink(v1, v2) and properties(Link) must not be used. */
+template <typename LINKPROPERTIES> struct link_property_gen
+{
+	typedef property<edge_properties_t, LINKPROPERTIES> type;
+};
+
+template <> struct link_property_gen<no_property>
+{
+	typedef no_property type;
+};
+
 /* the graph base class template */
 template < typename NODEPROPERTIES, typename LINKPROPERTIES >
 class BoostGraph
@@ -57,7 +71,7 @@ public:
 #endif 
 		undirectedS, // undirected graph
 		property<vertex_properties_t, NODEPROPERTIES>,
-		property<edge_properties_t, LINKPROPERTIES>
+		typename link_property_gen<LINKPROPERTIES>::type
 	> GraphContainer;
 
 
@@ -87,6 +101,12 @@ public:
 	BoostGraph(const BoostGraph& g) :
 		graph(g.graph){}
 
+	//Takes over the nodes and links of g without copying them, g is left empty
+	BoostGraph(BoostGraph&& g)
+	{
+		graph.swap(g.graph);
+	}
+
 	virtual ~BoostGraph(){}
 
 	/* structure modification methods */
@@ -95,6 +115,11 @@ public:
 		graph.clear();
 	}
 
+	void Swap(BoostGraph &g)
+	{
+		graph.swap(g.graph);
+	}
+
 	Node AddNode(const NODEPROPERTIES& prop)
 	{
 		Node v = add_vertex(graph);
@@ -125,6 +150,11 @@ public:
 		}
 	}
 
+	Link AddLink(const Node& v1, const Node& v2)
+	{
+		return add_edge(v1, v2, graph).first;
+	}
+
 	Link AddLink(const Node& v1, const Node& v2, const LINKPROPERTIES& prop_12)
 	{
 		/* TODO: maybe one wants to check if this edge could be inserted */
@@ -297,6 +327,13 @@ public:
 		return *this;
 	}
 
+	BoostGraph& operator=(BoostGraph &&rhs)
+	{
+		graph.swap(rhs.graph);
+		rhs.graph.clear();
+		return *this;
+	}
+
 protected:
 	GraphContainer graph;
 };
@@ -18,8 +18,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 Contents:
 This file contains BoostGraphIO class definition that is used to load
 and write networks. It allows the user to easily load XGMML, 
-simple TSV, and funcoup TSV graphs. It currently only writes 
-simple TSV graphs. 
+simple TSV, and funcoup TSV graphs. It writes simple TSV
+and XGMML graphs through an OutputBuffer. It also keeps a binary cache
+of a loaded network next to its file, so that reruns on the same network
+skip parsing. Networks may be gzip or zstd compressed, see inputstream.h.
 
 */
 
@@ -28,113 +30,233 @@ simple TSV graphs.
 #include <sstream>
 #include <stdlib.h>
 #include <string.h>
-#include <libxml/tree.h>
+#include <thread>
+#include <ctype.h>
+#include <libxml/xmlreader.h>
+#include <boost/unordered_map.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include "boostgraphio.h"
+#include "mappedfile.h"
+#include "inputstream.h"
+#include "outputbuffer.h"
+#include "textscan.h"
 #include "defines.h"
 #include "types.h"
 
 using namespace std;
 
-#define SIMPLE_TSV		3
-#define FUNCOUP_TSV		7
+#define SIMPLE_TSV		0 //TSVFormat types
+#define COLUMN_TSV		1
+#define SIMPLE_TSV_CELLS	3 //a first line with more cells is a FunCoup file
+
+#define XML_SNIFF_BYTES		64 //bytes read to tell an XGMML file from a TSV file
+#define TSV_MIN_CHUNK_BYTES	(1 << 20) //smallest part of a TSV file parsed by its own thread
 
 void err(void *ctx, const char *msg, ...) 
 {
 }
  
-Graph& BoostGraphIO::readGraph(string path)
+//isXGMMLFile:
+//	True if the network at path is XGMML, told from its first decompressed bytes: an xml file
+//	starts with '<' after an optional byte order mark and whitespace. Exits if it can not be opened.
+static bool isXGMMLFile(const string &path)
 {
-	ifstream file;
-	file.open(path.c_str());
-	if (!file)
+	InputStream file;
+	char head[XML_SNIFF_BYTES];
+	int n, k = 0;
+	
+	if (!file.open(path))
 	{
 		cout << "Error in opening "<< path << endl;
 		exit(1);
 	}
+	n = file.read(head, sizeof(head));
 	file.close();
 	
-	xmlGenericErrorFunc handler = (xmlGenericErrorFunc)err;
-	initGenericErrorDefaultFunc(&handler);
-	
-	//determine if path is tsv or xgmml
-	xmlDocPtr doc = xmlParseFile(path.c_str());
-	if (!doc)
+	if (n >= 3 && (unsigned char)head[0] == 0xEF && (unsigned char)head[1] == 0xBB && (unsigned char)head[2] == 0xBF)
+		k = 3;
+	while (k < n && isspace((unsigned char)head[k]))
+		k++;
+	return k < n && head[k] == '<';
+}
+
+Graph& BoostGraphIO::readGraph(string path)
+{
+	if (isXGMMLFile(path))
+		return readXGMMLGraph(path);
+	if (!networkColumns.empty())
+		return readColumnTSVGraph(path, networkColumns);
+	return readTSVGraph(path);	
+}
+
+void BoostGraphIO::readNetwork(string path, CSRGraph &net)
+{
+	if (isXGMMLFile(path))
 	{
-		return readTSVGraph(path);	
+		readXGMMLGraph(path);
+		net.build(*graphPtr, keepLinkWeights ? &linkWeights : NULL);
+		clearGraph();
+		return;
 	}
-	else
+	readTSVNetwork(path, networkColumns.empty() ? getTSVFormat(path) : getColumnTSVFormat(path, networkColumns), net);
+}
+
+//readXGMMLAttributes:
+//	Reads the attributes of the element the reader is on into names and values, both in
+//	document order, and returns their number. The strings of values are reused from element 
+//	to element so that reading an element does not allocate once they have grown.
+static int readXGMMLAttributes(xmlTextReaderPtr reader, vector<const char*> &names, vector<string> &values)
+{
+	const char *value;
+	int count = 0;
+	
+	names.clear();
+	while (xmlTextReaderMoveToNextAttribute(reader) == 1)
 	{
-		xmlFreeDoc(doc);
-		return readXGMMLGraph(path);
+		names.push_back((const char*)xmlTextReaderConstLocalName(reader));
+		value = (const char*)xmlTextReaderConstValue(reader);
+		if ((int)values.size() <= count)
+			values.resize(count+1);
+		values[count++].assign(value ? value : "");
 	}
+	xmlTextReaderMoveToElement(reader);
+	return count;
+}
+
+//returns the value of attribute name from readXGMMLAttributes or NULL if the element does not have it
+static const char* getXGMMLAttribute(const vector<const char*> &names, const vector<string> &values, const char *name)
+{
+	for (int k = 0; k < (int)names.size(); k++)
+		if (!strcmp(names[k], name))
+			return values[k].c_str();
+	return NULL;
+}
+
+//the xmlReaderForIO callback reading a compressed XGMML file from an InputStream
+static int readXGMMLInput(void *context, char *buffer, int len)
+{
+	return ((InputStream*)context)->read(buffer, len);
 }
 
 Graph& BoostGraphIO::readXGMMLGraph(string path)
 {
 	//assume the user sends a path that is xgmml
-	xmlDocPtr doc;
-	xmlNodePtr nodeLevel1, nodeLevel2;
+	xmlTextReaderPtr reader;
+	InputStream input;
 	NodeProperties vp;
-	LinkProperties link;
-	string str1, str2, weight;
-	map<string, Graph::Node> idVertMap;
+	float linkWeight;
+	const char *name, *id, *label, *source, *target, *weight;
+	string str;
+	vector<const char*> attrNames;
+	vector<string> attrValues;
+	boost::unordered_map<string, Graph::Node> idVertMap;
+	boost::unordered_map<string, Graph::Node>::iterator it1, it2;
+	vector<pair<pair<string, string>, float> > pendingLinks; //links read before one of their nodes
+	vector<Graph::Node> isolated;
+	bool hasGraph = false;
+	int ret;
 	//clock_t start = clock();
 	
-	doc = xmlParseFile(path.c_str());
-	if (!doc)
-		{xmlFreeDoc(doc);cout << "Invalid XML file "<< path << endl;exit(1);}
+	xmlGenericErrorFunc handler = (xmlGenericErrorFunc)err;
+	initGenericErrorDefaultFunc(&handler);
+	
+	//compressed files are decompressed by an InputStream, libxml2 may not be built with zlib
+	if (detectCompression(path) != COMPRESSION_NONE)
+	{
+		if (!input.open(path))
+			{cout << "Error in opening "<< path << endl;exit(1);}
+		reader = xmlReaderForIO(readXGMMLInput, NULL, &input, path.c_str(), NULL, XML_PARSE_NONET | XML_PARSE_HUGE);
+	}
+	else
+		reader = xmlReaderForFile(path.c_str(), NULL, XML_PARSE_NONET | XML_PARSE_HUGE);
+	if (!reader)
+		{cout << "Invalid XML file "<< path << endl;exit(1);}
 
 	graphPtr->Clear();
 
-	nodeLevel1 = doc->children;
-	while (strcmp((const char*)nodeLevel1->name, "graph") && nodeLevel1 != NULL)
-		nodeLevel1 = nodeLevel1->next;
-	
-	if (nodeLevel1 == NULL)
-	{xmlFreeDoc(doc);cout << "Invalid XGMML format in "<< path <<endl;exit(1);}
-	
-	for(nodeLevel2 = nodeLevel1->children;
-		nodeLevel2 != NULL;
-		nodeLevel2 = nodeLevel2->next)
+	//one pass over the document, only the node and edge elements directly under the graph element are used
+	while ((ret = xmlTextReaderRead(reader)) == 1)
 	{
-		if (!strcmp((const char*)nodeLevel2->name, "node"))
+		if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT)
+			continue;
+		
+		name = (const char*)xmlTextReaderConstLocalName(reader);
+		if (xmlTextReaderDepth(reader) == 0)
+		{
+			if (strcmp(name, "graph"))
+				break;
+			hasGraph = true;
+			continue;
+		}
+		if (xmlTextReaderDepth(reader) != 1)
+			continue;
+		
+		if (!strcmp(name, "node"))
 		{
-			str1 = (char*)xmlGetProp(nodeLevel2, (xmlChar *)"id");
-			if (idVertMap[str1] == NULL)
+			readXGMMLAttributes(reader, attrNames, attrValues);
+			id = getXGMMLAttribute(attrNames, attrValues, "id");
+			label = getXGMMLAttribute(attrNames, attrValues, "label");
+			if (!id)
+				continue;
+			if (!label)
+				label = id;
+			
+			str = id;
+			if (idVertMap.find(str) == idVertMap.end())
 			{
-				vp.geneId = (char*)xmlGetProp(nodeLevel2, (xmlChar *)"label");
-				to_upper(vp.geneId);
-				idVertMap[str1] = graphPtr->AddNode(vp);
+				upperCopy(label, strlen(label), str);
+				vp.geneId = geneSymbols.intern(str);
+				idVertMap[id] = graphPtr->AddNode(vp);
 			}
 		}
-		if (!strcmp((const char*)nodeLevel2->name, "edge"))
+		else if (!strcmp(name, "edge"))
 		{
-			str1 = (char*)xmlGetProp(nodeLevel2, (xmlChar *)"source");
-			str2 = (char*)xmlGetProp(nodeLevel2, (xmlChar *)"target");
-			link.weight = cutoffScore;
-			if ((char*)xmlGetProp(nodeLevel2, (xmlChar *)"weight") != NULL && useCutoff)
+			readXGMMLAttributes(reader, attrNames, attrValues);
+			source = getXGMMLAttribute(attrNames, attrValues, "source");
+			target = getXGMMLAttribute(attrNames, attrValues, "target");
+			weight = getXGMMLAttribute(attrNames, attrValues, "weight");
+			if (!source || !target)
+				continue;
+			
+			linkWeight = 1; //links without a weight pass any cutoff
+			if (weight != NULL && (useCutoff || keepLinkWeights))
 			{
-				weight = (char*)xmlGetProp(nodeLevel2, (xmlChar *)"weight");
-				link.weight = atof(weight.c_str());
-				if (link.weight >= cutoffScore)
-					graphPtr->AddLink(idVertMap[str1], idVertMap[str2], link);	
-			}
-			else{	
-				graphPtr->AddLink(idVertMap[str1], idVertMap[str2], link);
+				linkWeight = atof(weight);
+				if (useCutoff && linkWeight < cutoffScore)
+					continue;
 			}
+			
+			it1 = idVertMap.find(source);
+			it2 = idVertMap.find(target);
+			if (it1 != idVertMap.end() && it2 != idVertMap.end())
+				addLink(it1->second, it2->second, linkWeight);
+			else
+				pendingLinks.push_back(make_pair(make_pair(string(source), string(target)), linkWeight));
 		}
 	}
+	xmlFreeTextReader(reader);
 	
-	xmlFreeDoc(doc);
+	if (ret < 0)
+		{cout << "Invalid XML file "<< path << endl;exit(1);}
+	if (!hasGraph)
+		{cout << "Invalid XGMML format in "<< path <<endl;exit(1);}
 	
-	//clear links with 0 connections
-	for (Graph::node_range_t vr = graphPtr->getNodes(); vr.first != vr.second; vr.first++)
+	//links to nodes declared after them, links to nodes that are never declared are dropped
+	for (int k = 0; k < (int)pendingLinks.size(); k++)
 	{
-		if (graphPtr->getNodeDegree(*vr.first) == 0)
-			graphPtr->RemoveNode(*vr.first);
+		it1 = idVertMap.find(pendingLinks[k].first.first);
+		it2 = idVertMap.find(pendingLinks[k].first.second);
+		if (it1 != idVertMap.end() && it2 != idVertMap.end())
+			addLink(it1->second, it2->second, pendingLinks[k].second);
 	}
+	
+	//clear nodes with 0 connections, collected first since removing a node invalidates the node iterator
+	for (Graph::node_range_t vr = graphPtr->getNodes(); vr.first != vr.second; vr.first++)
+		if (graphPtr->getNodeDegree(*vr.first) == 0)
+			isolated.push_back(*vr.first);
+	for (int k = 0; k < (int)isolated.size(); k++)
+		graphPtr->RemoveNode(isolated[k]);
 /*	
 #if USE_BIDIRECTIONAL
 	printf("Loaded %d links between %d nodes in %f seconds.\n", graphPtr->getLinkCount()/2, graphPtr->getNodeCount(), ((clock()-start)+0.0)/CLOCKS_PER_SEC);	
@@ -146,108 +268,236 @@ Graph& BoostGraphIO::readXGMMLGraph(string path)
 	return (*graphPtr);
 }
 
-Graph& BoostGraphIO::readTSVGraph(string path)
+TSVFormat BoostGraphIO::getTSVFormat(string path)
 {
-	ifstream file;
+	InputStream file;
 	string line;
-	vector<string> lineVals;
+	int countCell;
 	
-	file.open(path.c_str());
-	if (!file)
+	if (!file.open(path))
 	{
 		cout << "Error in opening "<< path << endl;
 		exit(1);
 	}
-	getline(file, line);
+	file.getline(line);
 	file.close();
 	
-	split(lineVals, line, is_any_of("\t "));
-	//cout << "size" << lineVals.size()<<endl;
-	if (lineVals.size() > SIMPLE_TSV)
+	//the cells of the first line, empty ones included
+	countCell = 1;
+	for (const char *p = line.data(), *end = p+line.size(); (p = scanField(p, end, DelimiterSet('\t', ' '))) != end; p++)
+		countCell++;
+	//cout << "size" << countCell <<endl;
+	if (countCell > SIMPLE_TSV_CELLS)
 	{
-		return readFunCoupTSVGraph(path);
+		return getFunCoupTSVFormat();
 	}
-	else if (lineVals.size() <= SIMPLE_TSV && lineVals.size() > 1)
+	else if (countCell <= SIMPLE_TSV_CELLS && countCell > 1)
 	{
-		return readSimpleTSVGraph(path);
+		return getSimpleTSVFormat();
 	}
 	else
 	{
 		cout << "Invalid TSV format in "<< path <<endl;
 		exit(1);
 	}
-	return graph;
+	return getSimpleTSVFormat();
 }
 
-Graph& BoostGraphIO::readSimpleTSVGraph(string path)
+TSVFormat BoostGraphIO::getSimpleTSVFormat()
 {
-	return __readTSVGraph__(path, SIMPLE_TSV);
+	TSVFormat format;
+	
+	format.type = SIMPLE_TSV;
+	format.gene1 = 0;
+	format.gene2 = 1;
+	format.score = 2;
+	format.lastColumn = 2;
+	format.separator = '\t';
+	format.header = false;
+	format.comments = false;
+	return format;
 }
 
-Graph& BoostGraphIO::readFunCoupTSVGraph(string path)
+TSVFormat BoostGraphIO::getFunCoupTSVFormat()
 {
-	return __readTSVGraph__(path, FUNCOUP_TSV);
+	TSVFormat format;
+	
+	format.type = COLUMN_TSV;
+	format.gene1 = FUNCOUP_PROTEIN1;
+	format.gene2 = FUNCOUP_PROTEIN2;
+	format.score = FUNCOUP_MAX_SCORE;
+	format.lastColumn = max(FUNCOUP_MAX_SCORE, max(FUNCOUP_PROTEIN1, FUNCOUP_PROTEIN2));
+	format.separator = '\t';
+	format.header = true;
+	format.comments = false;
+	return format;
 }
 
-Graph& BoostGraphIO::__readTSVGraph__(string path, int flag)
- {
-	//assume the user sends a path that is a tsv
-	ifstream file;
-	string line, cell, header;
-	NodeProperties vp;
-	LinkProperties link;
-	Graph::Node v1, v2;
-	int countCell = 0;
-	float maxScore = 0;
-	bool hasFirst, hasSecond;
-	string first, second;
-	stringstream lineStream;
-	map<string, Graph::Node> geneVertMap;
-	vector<string> lineVals;
+TSVFormat BoostGraphIO::getColumnTSVFormat(string path, string columns)
+{
+	InputStream file;
+	string line;
+	vector<string> names, headerCells;
+	int column[3] = {-1, -1, -1};
+	TSVFormat format;
 	
-	//clock_t start = clock();
-
-	file.open(path.c_str());
-	if (!file)
+	if (!file.open(path))
 	{
 		cout << "Error in opening "<< path << endl;
 		exit(1);
 	}
+	file.getline(line);
+	file.close();
+	line.erase(line.find_last_not_of(" \n\r\t")+1);
 	
-	if (useCutoff)
-		cout << "Reading network from "<< path << " using link weight cutoff >= "<< cutoffScore <<" ..." << endl;
-	else
-		cout << "Reading network from "<< path << " ..." << endl;
+	format.type = COLUMN_TSV;
+	format.separator = (line.find('\t') != string::npos) ? '\t' : ' ';
+	format.header = false;
+	format.comments = true;
+	for (const char *p = line.data(), *end = p+line.size(), *cellEnd; ; p = cellEnd+1)
+	{
+		cellEnd = scanField(p, end, DelimiterSet(format.separator));
+		headerCells.push_back(string(p, cellEnd));
+		if (cellEnd == end)
+			break;
+	}
+	
+	split(names, columns, is_any_of(","));
+	if (names.size() != 2 && names.size() != 3)
+	{
+		cout << "Invalid network columns "<< columns << ", expected gene1,gene2[,score]" << endl;
+		exit(1);
+	}
+	for (int k = 0; k < (int)names.size(); k++)
+	{
+		trim(names[k]);
+		if (!names[k].empty() && all(names[k], is_digit()))
+			column[k] = atoi(names[k].c_str())-1;
+		else
+		{
+			//a name of a header cell, a comment mark before the first name is ignored
+			for (int c = 0; c < (int)headerCells.size() && column[k] < 0; c++)
+				if (headerCells[c] == names[k] || (c == 0 && headerCells[c] == "#" + names[k]))
+					column[k] = c;
+			format.header = true;
+		}
+		if (column[k] < 0)
+		{
+			cout << "Network column "<< names[k] << " not found in "<< path << endl;
+			exit(1);
+		}
+	}
+	format.gene1 = column[0];
+	format.gene2 = column[1];
+	format.score = column[2];
+	format.lastColumn = max(column[0], max(column[1], column[2]));
+	return format;
+}
+
+Graph& BoostGraphIO::readTSVGraph(string path)
+{
+	return __readTSVGraph__(path, getTSVFormat(path));
+}
+
+Graph& BoostGraphIO::readSimpleTSVGraph(string path)
+{
+	return __readTSVGraph__(path, getSimpleTSVFormat());
+}
+
+Graph& BoostGraphIO::readFunCoupTSVGraph(string path)
+{
+	return __readTSVGraph__(path, getFunCoupTSVFormat());
+}
+
+Graph& BoostGraphIO::readColumnTSVGraph(string path, string columns)
+{
+	return __readTSVGraph__(path, getColumnTSVFormat(path, columns));
+}
+
+Graph& BoostGraphIO::__readTSVGraph__(string path, const TSVFormat &format)
+{
+	CSRGraph net;
+	vector<Graph::Node> nodes;
+	CSRGraph::adjacency_node_range_t avr;
+	NodeProperties vp;
 	
-	if(flag == FUNCOUP_TSV)getline(file, header);
+	//the snapshot is built first, as for readNetwork, and copied into the graph in its node order
+	readTSVNetwork(path, format, net);
+	clearGraph();
+	for (CSRGraph::NodeId v = 0; v < (CSRGraph::NodeId)net.getNodeCount(); v++)
+	{
+		vp.geneId = net.getGeneId(v);
+		nodes.push_back(graphPtr->AddNode(vp));
+	}
+	for (CSRGraph::NodeId v = 0; v < (CSRGraph::NodeId)net.getNodeCount(); v++)
+		for (avr = net.getLinkNeighbors(v); avr.first != avr.second; avr.first++)
+			addLink(nodes[v], nodes[*avr.first], net.getLinkWeight(v, *avr.first, 1));
+	return (*graphPtr);
+}
 
-	//could do some file type validation here...
-	graphPtr->Clear();
-		
+//internGene:
+//	Returns the symbol in table of the gene named by s, upper cased and without trailing whitespace.
+//	lower tells if s has lower case letters, as found by scanField. Names without are interned
+//	straight from the file bytes, others are upper cased into buf, which keeps its capacity.
+static SymbolTable::Symbol internGene(SymbolTable &table, TextSlice s, bool lower, string &buf)
+{
+	s = trimRight(s);
+	if (!lower)
+		return table.intern(s.first, s.size());
+	
+	upperCopy(s, buf);
+	return table.intern(buf.data(), buf.size());
+}
+
+void BoostGraphIO::parseTSVChunk(const char *begin, const char *end, const TSVFormat *format, TSVChunk *chunk)
+{
+	TextSlice line, first, second;
+	TextSlice cells[3];
+	bool lowers[3], lower, firstLower = false, secondLower = false;
+	const char *p = begin, *cell, *cellEnd;
+	const DelimiterSet blanks('\t', ' '), separator(format->separator);
+	int countCell = 0;
+	float maxScore = 0;
+	bool dropped;
+	
 #if DO_LINE_LIMIT
 	int countLines = 0;
-	while(getline(file, line) && countLines < MAX_LINES)
+	while(p != end && countLines < MAX_LINES)
 	{
 		countLines++;
 #else
-	while(getline(file, line))
+	while(p != end)
 	{
 #endif
-		switch(flag)
+		p = nextLine(p, end, line);
+		first = second = TextSlice();
+		
+		switch(format->type)
 		{
 			case SIMPLE_TSV:
-				split(lineVals, line, is_any_of("\t "));
-				switch(lineVals.size())
+				//cells are separated by a tab or a space, the line is only split up to the score
+				//in the third cell so that a link under the cutoff is dropped as soon as it is read
+				countCell = 0;
+				for (cell = line.first; countCell < 3; cell = cellEnd+1)
+				{
+					lowers[countCell] = false;
+					cellEnd = scanField(cell, line.last, blanks, lowers[countCell]);
+					cells[countCell++] = TextSlice(cell, cellEnd);
+					if (cellEnd == line.last)
+						break;
+				}
+				
+				switch(countCell)
 				{
 					case 2: //must be protein1\tprotein2
-						first = lineVals[0];
-						second = lineVals[1];
-						maxScore = cutoffScore+100.0; //no weight on link so add a little to pass the test below
+						maxScore = 1; //no weight on link, it passes any cutoff
 						break;
 					case 3: //must be protein1\tprotein2\tscore
-						first = lineVals[0];
-						second = lineVals[1];
-						maxScore = atof(lineVals[2].c_str());
+						maxScore = sliceToFloat(cells[2]);
+						if (useCutoff && !(maxScore >= cutoffScore))
+							continue;
+						if (cellEnd != line.last) //more than three cells
+							continue;
 						break;
 					default:
 						//cout << "Invalid TSV format in "<<path<<endl;
@@ -255,119 +505,709 @@ Graph& BoostGraphIO::__readTSVGraph__(string path, int flag)
 						continue;
 						break;
 				}
-			
+				first = cells[0];
+				second = cells[1];
+				firstLower = lowers[0];
+				secondLower = lowers[1];
 				break;
-			case FUNCOUP_TSV:		
-				//parse the line
-				lineStream.str(line);
+			case COLUMN_TSV:
+				//the line is split up to the last column used, a link under the cutoff
+				//is dropped as soon as its score cell is found
+				if (format->comments && !line.empty() && line.first[0] == '#')
+					continue;
+				dropped = false;
 				countCell = 0;
-				while(getline(lineStream, cell, '\t') && countCell < 7)
+				maxScore = 1; //links without a score pass any cutoff
+				for (cell = line.first; countCell <= format->lastColumn; cell = cellEnd+1, countCell++)
 				{
-					if (countCell == FUNCOUP_MAX_SCORE)
-						maxScore = atof(cell.c_str());
-					else if (countCell == FUNCOUP_PROTEIN1)
-						first = cell;
-					else if (countCell == FUNCOUP_PROTEIN2)
-						second = cell;
-					countCell++;
+					lower = false;
+					cellEnd = scanField(cell, line.last, separator, lower);
+					if (countCell == format->gene1)
+					{
+						first = TextSlice(cell, cellEnd);
+						firstLower = lower;
+					}
+					if (countCell == format->gene2)
+					{
+						second = TextSlice(cell, cellEnd);
+						secondLower = lower;
+					}
+					if (countCell == format->score)
+					{
+						maxScore = sliceToFloat(TextSlice(cell, cellEnd));
+						if (useCutoff && !(maxScore >= cutoffScore))
+						{
+							dropped = true;
+							break;
+						}
+					}
+					if (cellEnd == line.last)
+					{
+						countCell++;
+						break;
+					}
 				}
+				if (dropped || countCell <= format->lastColumn)
+					continue;
 				break;
 			default:
 				break;
 		}
 			
-		if (!first.size() || !second.size())
+		if (first.empty() || second.empty())
 			continue;
-			
-		if ((maxScore >= cutoffScore && useCutoff) || !useCutoff)
-		{
-			to_upper(first);
-			to_upper(second);
-			first.erase(first.find_last_not_of(" \n\r\t")+1);
-			second.erase(second.find_last_not_of(" \n\r\t")+1);
 		
-			hasFirst = (geneVertMap[first] != NULL);
-			hasSecond = (geneVertMap[second] != NULL);
+		//only links that passed the cutoff get here, their genes are interned
+		SymbolTable::Symbol firstId = internGene(chunk->genes, first, firstLower, chunk->nameBuf);
+		SymbolTable::Symbol secondId = internGene(chunk->genes, second, secondLower, chunk->nameBuf);
+		chunk->links.push_back(pair<SymbolTable::Symbol, SymbolTable::Symbol>(firstId, secondId));
+		chunk->scores.push_back(maxScore);
+	}
+}
 
-			//The following logic is based upon the assumption that the 
-			//results from FunCoup are not directional.
-			if (!hasFirst && !hasSecond)
-			{
-				vp.geneId = first;
-				v1 = graphPtr->AddNode(vp);
-				vp.geneId = second;
-				v2 = graphPtr->AddNode(vp);
-			
-				geneVertMap[first] = v1;
-				geneVertMap[second] = v2;
-				
-				link.weight = maxScore;
-				graphPtr->AddLink(v1, v2, link, link);
-				
-			}
-			else if(hasFirst && !hasSecond)
-			{		
-				v1 = geneVertMap[first];
-				vp.geneId = second;
-				v2 = graphPtr->AddNode(vp);
-			
-				geneVertMap[second] = v2;
-			
-				link.weight = maxScore;
-				graphPtr->AddLink(v1, v2, link, link);
-			}
-			else if (hasSecond && !hasFirst)
-			{
-				vp.geneId = first;
-				v1 = graphPtr->AddNode(vp);
-				v2 = geneVertMap[second];
-				
-				geneVertMap[first] = v1;
-			
-				link.weight = maxScore;
-				graphPtr->AddLink(v1, v2, link, link);
-			}
-			else
+void BoostGraphIO::numberTSVChunkGenes(TSVChunk &chunk, vector<CSRGraph::NodeId> &nodeOf, vector<SymbolTable::Symbol> &genes, vector<CSRGraph::NodeId> &ids)
+{
+	SymbolTable::Symbol s;
+	
+	//the chunk interned its genes in the order they first appear in its links, so numbering
+	//them in that order gives the symbols and nodes a serial read of the file would
+	ids.resize(chunk.genes.size());
+	for (int k = 0; k < chunk.genes.size(); k++)
+	{
+		s = geneSymbols.intern(chunk.genes.getName(k));
+		if ((int)nodeOf.size() <= (int)s)
+			nodeOf.resize(s+1, CSRGraph::NONE);
+		if (nodeOf[s] == CSRGraph::NONE)
+		{
+			nodeOf[s] = genes.size();
+			genes.push_back(s);
+		}
+		ids[k] = nodeOf[s];
+	}
+	chunk.genes.clear();
+}
+
+void BoostGraphIO::renumberTSVChunkLinks(TSVChunk *chunk, const vector<CSRGraph::NodeId> *ids)
+{
+	for (size_t k = 0; k < chunk->links.size(); k++)
+	{
+		chunk->links[k].first = (*ids)[chunk->links[k].first];
+		chunk->links[k].second = (*ids)[chunk->links[k].second];
+	}
+}
+
+//sortNeighbors:
+//	Sorts the neighbors of the nodes [first, last), neighbors[offsets[v]..offsets[v+1]) with the weights
+//	parallel to them if weights is not NULL, and keeps each neighbor once, at the front of the range, with
+//	the weight it was read with last. The kept counts go to sizes. A link of a node to itself is kept
+//	twice, once for each end, as CSRGraph::build stores it.
+static void sortNeighbors(CSRGraph::NodeId first, CSRGraph::NodeId last, const vector<uint32_t> *offsets,
+				vector<CSRGraph::NodeId> *neighbors, vector<float> *weights, vector<uint32_t> *sizes)
+{
+	vector<pair<CSRGraph::NodeId, float> > adjacency;
+	CSRGraph::NodeId *begin, *end, *self;
+	uint32_t size;
+	
+	for (CSRGraph::NodeId v = first; v < last; v++)
+	{
+		begin = neighbors->data()+(*offsets)[v];
+		end = neighbors->data()+(*offsets)[v+1];
+		if (!weights)
+		{
+			sort(begin, end);
+			size = unique(begin, end)-begin;
+		}
+		else
+		{
+			//stable, so that the links read twice stay in file order
+			adjacency.clear();
+			for (uint32_t k = (*offsets)[v]; k < (*offsets)[v+1]; k++)
+				adjacency.push_back(make_pair((*neighbors)[k], (*weights)[k]));
+			stable_sort(adjacency.begin(), adjacency.end(), 
+				[](const pair<CSRGraph::NodeId, float> &a, const pair<CSRGraph::NodeId, float> &b){return a.first < b.first;});
+			size = 0;
+			for (uint32_t k = 0; k < adjacency.size(); k++)
 			{
-				v1 = geneVertMap[first];
-				v2 = geneVertMap[second];
-				
-				link.weight = maxScore;
-				graphPtr->AddLink(v1, v2, link, link);
+				if (size && begin[size-1] == adjacency[k].first)
+					size--;
+				begin[size] = adjacency[k].first;
+				(*weights)[(*offsets)[v]+size++] = adjacency[k].second;
 			}
-		}	
+		}
+		
+		self = lower_bound(begin, begin+size, v);
+		if (self != begin+size && *self == v)
+		{
+			copy_backward(self, begin+size, begin+size+1);
+			if (weights)
+				copy_backward(weights->data()+(*offsets)[v]+(self-begin), weights->data()+(*offsets)[v]+size, 
+					weights->data()+(*offsets)[v]+size+1);
+			size++;
+		}
+		(*sizes)[v] = size;
 	}
-	file.close();
+}
 
-/*		
-#if USE_BIDIRECTIONAL
-	printf("Loaded %d links between %d nodes in %f seconds.\n", graphPtr->getLinkCount()/2, graphPtr->getNodeCount(), ((clock()-start)+0.0)/CLOCKS_PER_SEC);	
-#else 
-	printf("Loaded %d links between %d nodes in %f seconds.\n", graphPtr->getLinkCount(), graphPtr->getNodeCount(), ((clock()-start)+0.0)/CLOCKS_PER_SEC);	
+//packNeighbors: moves the kept neighbors of the nodes [first, last) from sortNeighbors to their place in packed
+static void packNeighbors(CSRGraph::NodeId first, CSRGraph::NodeId last, const vector<uint32_t> *offsets, const vector<uint32_t> *packedOffsets,
+				const vector<CSRGraph::NodeId> *neighbors, const vector<float> *weights, vector<CSRGraph::NodeId> *packed, vector<float> *packedWeights)
+{
+	for (CSRGraph::NodeId v = first; v < last; v++)
+	{
+		uint32_t size = (*packedOffsets)[v+1]-(*packedOffsets)[v];
+		copy(neighbors->begin()+(*offsets)[v], neighbors->begin()+(*offsets)[v]+size, packed->begin()+(*packedOffsets)[v]);
+		if (weights)
+			copy(weights->begin()+(*offsets)[v], weights->begin()+(*offsets)[v]+size, packedWeights->begin()+(*packedOffsets)[v]);
+	}
+}
+
+//forNodeParts:
+//	Runs f(first, last) on numThreads parts of the nodes of a graph with adjacency offsets, in parallel.
+//	The parts have about the same number of neighbors.
+template<typename F>
+static void forNodeParts(const vector<uint32_t> &offsets, F f)
+{
+	CSRGraph::NodeId n = offsets.size()-1, first = 0, last;
+	vector<std::thread> threads;
+	int parts = max(1, numThreads);
+	
+	for (int t = 1; t <= parts; t++)
+	{
+		last = (t == parts) ? n : lower_bound(offsets.begin(), offsets.end(), (uint32_t)((uint64_t)offsets[n]*t/parts)) - offsets.begin();
+		if (last > n)
+			last = n;
+		if (last < first)
+			last = first;
+		if (t == parts)
+			f(first, last);
+		else
+			threads.push_back(std::thread(f, first, last));
+		first = last;
+	}
+	for (int t = 0; t < (int)threads.size(); t++)
+		threads[t].join();
+}
+
+void BoostGraphIO::buildTSVNetwork(vector<TSVChunk> &chunks, vector<SymbolTable::Symbol> &genes, CSRGraph &net)
+{
+	CSRGraph::NodeId n = genes.size(), a, b;
+	vector<uint32_t> offsets(n+1, 0), fill, sizes(n), packedOffsets(n+1, 0);
+	vector<CSRGraph::NodeId> neighbors, packed;
+	vector<float> weights, packedWeights;
+	vector<float> *weightsPtr = keepLinkWeights ? &weights : NULL;
+	
+	//every link in both directions, in file order
+	for (int c = 0; c < (int)chunks.size(); c++)
+		for (size_t k = 0; k < chunks[c].links.size(); k++)
+		{
+			offsets[chunks[c].links[k].first+1]++;
+			offsets[chunks[c].links[k].second+1]++;
+		}
+	for (CSRGraph::NodeId v = 0; v < n; v++)
+		offsets[v+1] += offsets[v];
+	fill.assign(offsets.begin(), offsets.end()-1);
+	neighbors.resize(offsets[n]);
+	if (keepLinkWeights)
+		weights.resize(offsets[n]);
+	for (int c = 0; c < (int)chunks.size(); c++)
+	{
+		for (size_t k = 0; k < chunks[c].links.size(); k++)
+		{
+			a = chunks[c].links[k].first;
+			b = chunks[c].links[k].second;
+			//one after the other, as a link of a gene to itself fills two places of a
+			if (keepLinkWeights)
+				weights[fill[a]] = chunks[c].scores[k];
+			neighbors[fill[a]++] = b;
+			if (keepLinkWeights)
+				weights[fill[b]] = chunks[c].scores[k];
+			neighbors[fill[b]++] = a;
+		}
+		chunks[c] = TSVChunk();
+	}
+	
+	//the links read more than once are dropped in parallel, node by node
+	forNodeParts(offsets, [&](CSRGraph::NodeId first, CSRGraph::NodeId last){
+		sortNeighbors(first, last, &offsets, &neighbors, weightsPtr, &sizes);
+	});
+	for (CSRGraph::NodeId v = 0; v < n; v++)
+		packedOffsets[v+1] = packedOffsets[v] + sizes[v];
+	packed.resize(packedOffsets[n]);
+	if (keepLinkWeights)
+		packedWeights.resize(packedOffsets[n]);
+	forNodeParts(offsets, [&](CSRGraph::NodeId first, CSRGraph::NodeId last){
+		packNeighbors(first, last, &offsets, &packedOffsets, &neighbors, weightsPtr, &packed, &packedWeights);
+	});
+	neighbors.clear();
+	weights.clear();
+	net.build(genes, packedOffsets, packed, packedWeights, keepLinkWeights);
+}
+
+void BoostGraphIO::readTSVNetwork(string path, const TSVFormat &format, CSRGraph &net)
+ {
+	//assume the user sends a path that is a tsv
+	MappedFile file;
+	TextSlice line;
+	const char *p;
+	vector<SymbolTable::Symbol> genes; //node -> gene symbol
+	vector<CSRGraph::NodeId> nodeOf; //gene symbol -> node, CSRGraph::NONE if not yet a node
+	vector<vector<CSRGraph::NodeId> > ids; //per chunk, chunk symbol -> node
+	vector<const char*> bounds;
+	vector<TSVChunk> chunks;
+	vector<std::thread> threads;
+	int numChunks = numThreads;
+	int compression = detectCompression(path);
+	
+	//clock_t start = clock();
+
+	if (compression == COMPRESSION_NONE && !file.open(path))
+	{
+		cout << "Error in opening "<< path << endl;
+		exit(1);
+	}
+	
+	if (useCutoff)
+		cout << "Reading network from "<< path << " using link weight cutoff >= "<< cutoffScore <<" ..." << endl;
+	else
+		cout << "Reading network from "<< path << " ..." << endl;
+	
+	if (compression != COMPRESSION_NONE)
+	{
+		readTSVStream(path, format, chunks, genes, nodeOf);
+		buildTSVNetwork(chunks, genes, net);
+		return;
+	}
+	
+	p = file.begin();
+	if(format.header && p != file.end())
+		p = nextLine(p, file.end(), line); //header
+
+	//could do some file type validation here...
+	
+	//split the lines into one chunk per thread, small files are not worth a thread
+	if (numChunks < 1)
+		numChunks = 1;
+	if ((size_t)(file.end()-p) < (size_t)numChunks*TSV_MIN_CHUNK_BYTES)
+		numChunks = (file.end()-p)/TSV_MIN_CHUNK_BYTES + 1;
+#if DO_LINE_LIMIT
+	numChunks = 1; //the line limit counts from the start of the file
 #endif
-*/
-	return (*graphPtr);
+	bounds.push_back(p);
+	for (int c = 1; c < numChunks; c++)
+	{
+		const char *b = p + (file.end()-p)*(size_t)c/numChunks;
+		if (b < bounds.back())
+			b = bounds.back();
+		if (b != file.end() && b != p && b[-1] != '\n')
+			b = nextLine(b, file.end(), line);
+		bounds.push_back(b);
+	}
+	bounds.push_back(file.end());
+	
+	chunks.resize(numChunks);
+	for (int c = 1; c < numChunks; c++)
+		threads.push_back(std::thread(parseTSVChunk, bounds[c], bounds[c+1], &format, &chunks[c]));
+	parseTSVChunk(bounds[0], bounds[1], &format, &chunks[0]);
+	for (int t = 0; t < (int)threads.size(); t++)
+		threads[t].join();
+	threads.clear();
+	
+	//only the genes new to each chunk are numbered in file order, serially,
+	//the links of all chunks are renumbered at once
+	ids.resize(numChunks);
+	for (int c = 0; c < numChunks; c++)
+		numberTSVChunkGenes(chunks[c], nodeOf, genes, ids[c]);
+	for (int c = 1; c < numChunks; c++)
+		threads.push_back(std::thread(renumberTSVChunkLinks, &chunks[c], &ids[c]));
+	renumberTSVChunkLinks(&chunks[0], &ids[0]);
+	for (int t = 0; t < (int)threads.size(); t++)
+		threads[t].join();
+	file.close();
+	
+	//the snapshot is built exactly as from a graph read serially
+	buildTSVNetwork(chunks, genes, net);
 }
 
-//TODO: writers		
-void BoostGraphIO::writeXGMMLGraph(string path){}
+void BoostGraphIO::readTSVStream(string path, const TSVFormat &format, vector<TSVChunk> &chunks, 
+				vector<SymbolTable::Symbol> &genes, vector<CSRGraph::NodeId> &nodeOf)
+{
+	InputStream input;
+	TextSlice block, line;
+	vector<CSRGraph::NodeId> ids;
+	string text; //the unfinished last line of the blocks before, then the current block
+	const char *p, *last;
+	bool header = format.header;
+	
+	if (!input.open(path))
+	{
+		cout << "Error in opening "<< path << endl;
+		exit(1);
+	}
+	
+	//the input thread decompresses the next blocks while this one is parsed
+	for (bool more = true; more; )
+	{
+		more = input.nextBlock(block);
+		if (more)
+		{
+			text.append(block.first, block.last);
+			last = (const char*)memrchr(text.data(), '\n', text.size());
+			last = last ? last+1 : text.data();
+		}
+		else
+			last = text.data()+text.size(); //the last line need not end with '\n'
+		
+		p = text.data();
+		if (header && p != last)
+		{
+			p = nextLine(p, last, line);
+			header = false;
+		}
+		chunks.push_back(TSVChunk());
+		parseTSVChunk(p, last, &format, &chunks.back());
+		numberTSVChunkGenes(chunks.back(), nodeOf, genes, ids);
+		renumberTSVChunkLinks(&chunks.back(), &ids);
+		text.erase(0, last-text.data());
+	}
+}
+
+//openOutput: opens path for writing, exits if it can not be created
+static void openOutput(OutputBuffer &out, const string &path)
+{
+	if (!out.open(path))
+	{
+		cout << "Error in opening "<< path << endl;
+		exit(1);
+	}
+}
+
+//closeOutput: writes out the rest of the buffer, exits if any write failed
+static void closeOutput(OutputBuffer &out, const string &path)
+{
+	if (!out.close())
+	{
+		cout << "Error in writing "<< path << endl;
+		exit(1);
+	}
+}
+
+static void writeXGMMLHeader(OutputBuffer &out)
+{
+	out.put("<?xml version=\"1.0\"?>\n<graph label=\"CrossTalkZ\" xmlns=\"http://www.cs.rpi.edu/XGMML\">\n");
+}
+
+static void writeXGMMLNode(OutputBuffer &out, long long id, const string &label)
+{
+	out.put("  <node id=\"");
+	out.putInt(id);
+	out.put("\" label=\"");
+	out.putXML(label);
+	out.put("\"/>\n");
+}
+
+static void writeXGMMLEdge(OutputBuffer &out, long long source, long long target, float weight)
+{
+	out.put("  <edge source=\"");
+	out.putInt(source);
+	out.put("\" target=\"");
+	out.putInt(target);
+	out.put("\" weight=\"");
+	out.putFloat(weight);
+	out.put("\"/>\n");
+}
+
+float BoostGraphIO::getLinkWeight(const Graph::Node &v1, const Graph::Node &v2) const
+{
+	LinkWeights::const_iterator it = linkWeights.find(v1 < v2 ? make_pair(v1, v2) : make_pair(v2, v1));
+	return it == linkWeights.end() ? 1 : it->second;
+}
+
+void BoostGraphIO::writeGraph(string path, const CSRGraph &nodes, const LinkList &links, const vector<float> &weights)
+{
+	string ext = path.substr(path.find_last_of('.') == string::npos ? path.size() : path.find_last_of('.'));
+	
+	to_lower(ext);
+	if (ext == ".xgmml" || ext == ".xml")
+		writeXGMMLGraph(path, nodes, links, weights);
+	else
+		writeTSVGraph(path, nodes, links, weights);
+}
+
+void BoostGraphIO::writeXGMMLGraph(string path)
+{
+	OutputBuffer out;
+	boost::unordered_map<Graph::Node, long long> nodeIds;
+	Graph::Node v1, v2;
+	long long id = 0;
+	
+	openOutput(out, path);
+	writeXGMMLHeader(out);
+	for (Graph::node_range_t vr = graphPtr->getNodes(); vr.first != vr.second; vr.first++, id++)
+	{
+		nodeIds[*vr.first] = id;
+		writeXGMMLNode(out, id, geneSymbols.getName(graphPtr->properties(*vr.first).geneId));
+	}
+	for (Graph::link_range_t er = graphPtr->getLinks(); er.first != er.second; er.first++)
+	{
+		graphPtr->getNodesByLink(*er.first, v1, v2);
+		writeXGMMLEdge(out, nodeIds[v1], nodeIds[v2], getLinkWeight(v1, v2));
+	}
+	out.put("</graph>\n");
+	closeOutput(out, path);
+}
+
+void BoostGraphIO::writeXGMMLGraph(string path, const CSRGraph &nodes, const LinkList &links, const vector<float> &weights)
+{
+	OutputBuffer out;
+	
+	openOutput(out, path);
+	writeXGMMLHeader(out);
+	for (CSRGraph::NodeId v = 0; v < (CSRGraph::NodeId)nodes.getNodeCount(); v++)
+		writeXGMMLNode(out, v, geneSymbols.getName(nodes.getGeneId(v)));
+	for (size_t k = 0; k < links.size(); k++)
+		writeXGMMLEdge(out, links[k].first, links[k].second, weights.empty() ? 1 : weights[k]);
+	out.put("</graph>\n");
+	closeOutput(out, path);
+}
 
 void BoostGraphIO::writeTSVGraph(string path)
 {
-	ofstream file;
+	OutputBuffer out;
 	Graph::Node v1, v2;
 	Graph::Link e;
-	file.open(path.c_str());
+	
+	openOutput(out, path);
 	for (Graph::link_range_t er = graphPtr->getLinks(); er.first != er.second; er.first++)
 	{
 		e = *er.first;
 		graphPtr->getNodesByLink(e, v1, v2);
-		file << graphPtr->properties(v1).geneId << "\t" << graphPtr->properties(v2).geneId << "\t" << graphPtr->properties(e).weight << endl;
+		out.put(geneSymbols.getName(graphPtr->properties(v1).geneId));
+		out.put('\t');
+		out.put(geneSymbols.getName(graphPtr->properties(v2).geneId));
+		out.put('\t');
+		out.putFloat(getLinkWeight(v1, v2));
+		out.put('\n');
 	}
-	file.close();
+	closeOutput(out, path);
 }
 
+void BoostGraphIO::writeTSVGraph(string path, const CSRGraph &nodes, const LinkList &links, const vector<float> &weights)
+{
+	OutputBuffer out;
+	
+	openOutput(out, path);
+	for (size_t k = 0; k < links.size(); k++)
+	{
+		out.put(geneSymbols.getName(nodes.getGeneId(links[k].first)));
+		out.put('\t');
+		out.put(geneSymbols.getName(nodes.getGeneId(links[k].second)));
+		if (weights.empty())
+			out.put("\t1\n", 3);
+		else
+		{
+			out.put('\t');
+			out.putFloat(weights[k]);
+			out.put('\n');
+		}
+	}
+	closeOutput(out, path);
+}
+
+/* network cache */
+
+//the fixed part at the start of a network cache file, followed by
+//uint32 nameLengths[nameCount], char names[nameBytes] zero padded to a multiple of 4 bytes, uint32 geneIds[nodeCount],
+//uint32 offsets[nodeCount+1], uint32 neighbors[adjacencyCount] and, if CACHE_WEIGHTED, float weights[adjacencyCount]
+struct NetworkCacheHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;
+	uint64_t sourceSize;
+	int64_t sourceMtimeSec;
+	int64_t sourceMtimeNsec;
+	uint64_t sourceHash;
+	float cutoffScore;
+	uint32_t nameCount;
+	uint64_t columnsHash;	//of networkColumns
+	uint64_t nameBytes;
+	uint64_t nodeCount;
+	uint64_t adjacencyCount;
+};
+
+#define CACHE_MAGIC		"CTZNET\0\0"
+#define CACHE_VERSION		3
+#define CACHE_WEIGHTED		1 //the cache holds link weights
+#define CACHE_CUTOFF		2 //the links were filtered by cutoffScore
+//the names are padded so that the uint32 arrays after them stay 4 byte aligned
+#define CACHE_PADDED(n)		(((n) + 3) & ~(uint64_t)3)
+
+//getNetworkCacheKey:
+//	Fills in the fields of h that must match for a cache of the network at path to be reused,
+//	the content hash of the file only if withHash. Returns false if the file can not be read.
+static bool getNetworkCacheKey(const string &path, NetworkCacheHeader &h, bool withHash)
+{
+	MappedFile source;
+	struct stat st;
+
+	if (stat(path.c_str(), &st) < 0)
+		return false;
+	memcpy(h.magic, CACHE_MAGIC, sizeof(h.magic));
+	h.version = CACHE_VERSION;
+	h.flags = (keepLinkWeights ? CACHE_WEIGHTED : 0) | (useCutoff ? CACHE_CUTOFF : 0);
+	h.cutoffScore = useCutoff ? cutoffScore : 0;
+	h.columnsHash = hashBytes(networkColumns.data(), networkColumns.size());
+	h.sourceSize = st.st_size;
+	h.sourceMtimeSec = st.st_mtim.tv_sec;
+	h.sourceMtimeNsec = st.st_mtim.tv_nsec;
+	if (!withHash)
+		return true;
+	if (!source.open(path))
+		return false;
+	h.sourceHash = hashBytes(source.begin(), source.size());
+	return true;
+}
+
+//validNetworkCache:
+//	True if the arrays of a network cache of the size its header h gives agree with the header: the name
+//	lengths add up to nameBytes, the nodes are genes of the cache, the offsets rise from 0 to adjacencyCount
+//	and the neighbors of each node are nodes, sorted. A cache damaged in place keeps its size and key, this
+//	keeps it from being used.
+static bool validNetworkCache(const NetworkCacheHeader &h, const uint32_t *lengths, const uint32_t *ids, const uint32_t *offsets, const uint32_t *neighbors)
+{
+	uint64_t nameBytes = 0;
+	
+	for (uint64_t k = 0; k < h.nameCount; k++)
+		nameBytes += lengths[k];
+	if (nameBytes != h.nameBytes)
+		return false;
+	for (uint64_t k = 0; k < h.nodeCount; k++)
+		if (ids[k] >= h.nameCount)
+			return false;
+	if (offsets[0] != 0 || offsets[h.nodeCount] != h.adjacencyCount)
+		return false;
+	for (uint64_t k = 0; k < h.nodeCount; k++)
+		if (offsets[k+1] < offsets[k])
+			return false;
+	for (uint64_t k = 0; k < h.adjacencyCount; k++)
+		if (neighbors[k] >= h.nodeCount)
+			return false;
+	for (uint64_t v = 0; v < h.nodeCount; v++)
+		for (uint32_t k = offsets[v]+1; k < offsets[v+1]; k++)
+			if (neighbors[k] < neighbors[k-1])
+				return false;
+	return true;
+}
+
+bool BoostGraphIO::readNetworkCache(string path, CSRGraph &net)
+{
+	MappedFile cache;
+	NetworkCacheHeader stored, current;
+	vector<SymbolTable::Symbol> symbols, genes;
+	vector<uint32_t> offsets;
+	vector<CSRGraph::NodeId> neighbors;
+	vector<float> weights;
+	const uint32_t *lengths, *ids, *offs, *nbrs;
+	const char *names;
+	uint64_t expected;
+	uint32_t k;
+
+	if (!cache.open(path + NETWORK_CACHE_SUFFIX) || cache.size() < sizeof(stored))
+		return false;
+	memcpy(&stored, cache.begin(), sizeof(stored));
+	current = stored;
+	if (memcmp(stored.magic, CACHE_MAGIC, sizeof(stored.magic)) || stored.version != CACHE_VERSION)
+		return false;
+
+	//size and time first, the content hash only if they still match
+	if (!getNetworkCacheKey(path, current, false) || current.sourceSize != stored.sourceSize
+		|| current.sourceMtimeSec != stored.sourceMtimeSec || current.sourceMtimeNsec != stored.sourceMtimeNsec
+		|| current.flags != stored.flags || current.cutoffScore != stored.cutoffScore || current.columnsHash != stored.columnsHash)
+		return false;
+	if (!getNetworkCacheKey(path, current, true) || current.sourceHash != stored.sourceHash)
+		return false;
+
+	//the counts bound the sizes below, so that corrupted counts can not wrap them around
+	if (stored.nameCount > cache.size() || stored.nameBytes > cache.size() || stored.nodeCount > cache.size()
+		|| stored.adjacencyCount > cache.size() || stored.nodeCount >= CSRGraph::NONE)
+		return false;
+	expected = sizeof(stored) + 4*(uint64_t)stored.nameCount + CACHE_PADDED(stored.nameBytes) + 4*stored.nodeCount
+		+ 4*(stored.nodeCount+1) + 4*stored.adjacencyCount + ((stored.flags & CACHE_WEIGHTED) ? 4*stored.adjacencyCount : 0);
+	if (cache.size() != expected)
+		return false;
+
+	lengths = (const uint32_t*)(cache.begin() + sizeof(stored));
+	ids = (const uint32_t*)(cache.begin() + sizeof(stored) + 4*(uint64_t)stored.nameCount + CACHE_PADDED(stored.nameBytes));
+	offs = ids + stored.nodeCount;
+	nbrs = offs + stored.nodeCount+1;
+	if (!validNetworkCache(stored, lengths, ids, offs, nbrs))
+		return false;
+
+	cout << "Reading network from cache " << path + NETWORK_CACHE_SUFFIX << " ..." << endl;
+	names = (const char*)(lengths + stored.nameCount);
+	symbols.resize(stored.nameCount);
+	for (k = 0; k < stored.nameCount; k++)
+	{
+		symbols[k] = geneSymbols.intern(names, lengths[k]);
+		names += lengths[k];
+	}
+
+	genes.resize(stored.nodeCount);
+	for (k = 0; k < stored.nodeCount; k++)
+		genes[k] = symbols[ids[k]];
+	offsets.assign(offs, offs + stored.nodeCount+1);
+	neighbors.assign(nbrs, nbrs + stored.adjacencyCount);
+	if (stored.flags & CACHE_WEIGHTED)
+		weights.assign((const float*)(nbrs + stored.adjacencyCount), (const float*)(nbrs + stored.adjacencyCount) + stored.adjacencyCount);
+	net.build(genes, offsets, neighbors, weights, stored.flags & CACHE_WEIGHTED);
+	return true;
+}
 
+void BoostGraphIO::writeNetworkCache(string path, const CSRGraph &net)
+{
+	NetworkCacheHeader h;
+	vector<uint32_t> lengths, ids;
+	string tmp = path + NETWORK_CACHE_SUFFIX + ".tmp";
+	ofstream file;
+	SymbolTable::Symbol s;
+	int v;
 
+	memset(&h, 0, sizeof(h));
+	if (!getNetworkCacheKey(path, h, true))
+		return;
+	h.nameCount = geneSymbols.size();
+	for (s = 0; s < h.nameCount; s++)
+	{
+		lengths.push_back(geneSymbols.getName(s).size());
+		h.nameBytes += lengths.back();
+	}
+	h.nodeCount = net.getNodeCount();
+	h.adjacencyCount = net.getNeighbors().size();
+	for (v = 0; v < net.getNodeCount(); v++)
+		ids.push_back(net.getGeneId(v));
 
+	file.open(tmp.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!file.is_open())
+	{
+		cout << "Could not write network cache " << tmp << endl;
+		return;
+	}
+	file.write((const char*)&h, sizeof(h));
+	file.write((const char*)&lengths[0], 4*lengths.size());
+	for (s = 0; s < h.nameCount; s++)
+		file.write(geneSymbols.getName(s).data(), lengths[s]);
+	file.write("\0\0\0", CACHE_PADDED(h.nameBytes) - h.nameBytes);
+	file.write((const char*)&ids[0], 4*ids.size());
+	file.write((const char*)&net.getOffsets()[0], 4*net.getOffsets().size());
+	file.write((const char*)&net.getNeighbors()[0], 4*h.adjacencyCount);
+	if (h.flags & CACHE_WEIGHTED)
+		file.write((const char*)net.getWeights().data(), 4*net.getWeights().size());
+	file.close();
+	//a cache is only ever seen whole
+	if (file.fail() || rename(tmp.c_str(), (path + NETWORK_CACHE_SUFFIX).c_str()))
+	{
+		cout << "Could not write network cache " << path + NETWORK_CACHE_SUFFIX << endl;
+		remove(tmp.c_str());
+	}
+}
 
@@ -18,8 +18,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 Contents:
 This file contains BoostGraphIO class declaration that is used to load
 and write networks. It allows the user to easily load XGMML, 
-simple TSV, and funcoup TSV graphs. It currently only writes 
-simple TSV graphs. 
+simple TSV, and funcoup TSV graphs. It writes simple TSV
+and XGMML graphs. It also keeps a binary cache of a loaded network next
+to its file, so that reruns on the same network skip parsing. Networks
+may be gzip or zstd compressed, see inputstream.h.
 
 */
 
@@ -28,11 +30,36 @@ simple TSV graphs.
 
 #include "defines.h"
 #include "types.h"
+#include "randomgraph.h"
 
 using namespace std;
 
 extern float cutoffScore;
 extern bool useCutoff;
+extern int numThreads;
+extern string networkColumns;
+extern bool keepLinkWeights;
+
+//the layout of the links in a TSV file
+struct TSVFormat
+{
+	int type;	//SIMPLE_TSV: 2 or 3 cells separated by tabs or spaces, COLUMN_TSV: the columns below
+	int gene1, gene2, score;	//0 based columns, score is -1 if the links have no score
+	int lastColumn;	//the largest of the columns, cells after it are not split
+	char separator;
+	bool header;	//the first line is skipped
+	bool comments;	//lines starting with '#' are skipped
+};
+
+//the links read from one chunk of a TSV file, with the genes interned into the chunk's own table.
+//Once numbered the links are pairs of node ids and genes is empty.
+struct TSVChunk
+{
+	SymbolTable genes;
+	vector<pair<SymbolTable::Symbol, SymbolTable::Symbol> > links;
+	vector<float> scores;
+	string nameBuf;
+};
 
 class BoostGraphIO
 {
@@ -43,6 +70,11 @@ public:
 	
 	Graph& readGraph(string path);
 	
+	//readNetwork:
+	//	Reads the network file at path, XGMML or TSV as readGraph, into net. TSV files are read
+	//	without a graph, in the format given by networkColumns if it is set.
+	void readNetwork(string path, CSRGraph &net);
+	
 	//See: http://en.wikipedia.org/wiki/XGMML
 	Graph& readXGMMLGraph(string path);
 	
@@ -57,19 +89,93 @@ public:
 	//readFunCoupTSVGraph FunCoup file: http://funcoup.sbc.su.se/
 	Graph& readFunCoupTSVGraph(string path);
 	
-	void setGraph(Graph *g){graphPtr = g; graph = *graphPtr;}
-	void setGraph(Graph &g){graph = g;}
-	Graph& getGraph(){return graph;}
+	//readColumnTSVGraph:
+	//	Reads the links from the columns given in columns, "gene1,gene2[,score]". A column is
+	//	either its 1 based number or its name in the header line, the header is skipped if names
+	//	are used. Cells are separated by tabs, or by spaces if the first line has no tab.
+	//	Lines starting with '#' are skipped.
+	Graph& readColumnTSVGraph(string path, string columns);
+	
+	//the reader works on *g from now on, g is borrowed and not copied
+	void setGraph(Graph *g){graphPtr = g;}
+	//the reader takes over g's nodes and links, g is left empty
+	void setGraph(Graph &&g){graph = std::move(g); graphPtr = &graph;}
+	Graph& getGraph(){return *graphPtr;}
 	
 	void writeXGMMLGraph(string path);
 	void writeTSVGraph(string path);
 	
-	void clearGraph(){graphPtr->Clear();}
+	//writeGraph calls writeXGMMLGraph if path ends in .xgmml or .xml and writeTSVGraph otherwise
+	void writeGraph(string path, const CSRGraph &nodes, const LinkList &links, const vector<float> &weights);
+	
+	//write the links of a randomized network, pairs of node ids of nodes, with the weights
+	//parallel to them or, if weights is empty, with weight 1
+	void writeXGMMLGraph(string path, const CSRGraph &nodes, const LinkList &links, const vector<float> &weights);
+	void writeTSVGraph(string path, const CSRGraph &nodes, const LinkList &links, const vector<float> &weights);
+	
+	void clearGraph(){graphPtr->Clear(); linkWeights.clear();}
+	
+	//the weights of the links read into the graph if keepLinkWeights, else empty
+	const LinkWeights& getLinkWeights() const {return linkWeights;}
+	float getLinkWeight(const Graph::Node &v1, const Graph::Node &v2) const;
+	
+	//readNetworkCache:
+	//	Fills net from the cache of the network file at path, path+NETWORK_CACHE_SUFFIX, and interns its genes.
+	//	Returns false, leaving net alone, if there is no cache or it was written for another version of the
+	//	file (size, modification time and content hash), another cutoff or another link weight setting,
+	//	or if its arrays do not agree with its header.
+	bool readNetworkCache(string path, CSRGraph &net);
+	
+	//writes the cache of the network file at path loaded into net, replacing any older cache
+	void writeNetworkCache(string path, const CSRGraph &net);
 	
 protected:
-	Graph& __readTSVGraph__(string path, int flag);
+	Graph& __readTSVGraph__(string path, const TSVFormat &format);
+	
+	//readTSVNetwork:
+	//	Reads the links of the TSV file at path straight into net, the chunks of the file are parsed
+	//	and their links numbered in parallel. The nodes, neighbors and weights are the ones a serial
+	//	read into a graph and CSRGraph::build would give.
+	void readTSVNetwork(string path, const TSVFormat &format, CSRGraph &net);
+	
+	//reads a compressed TSV file block by block as it is decompressed, one chunk per block
+	void readTSVStream(string path, const TSVFormat &format, vector<TSVChunk> &chunks, 
+				vector<SymbolTable::Symbol> &genes, vector<CSRGraph::NodeId> &nodeOf);
+	
+	//parses the lines in [begin, end) of a TSV file into chunk, safe to run concurrently
+	static void parseTSVChunk(const char *begin, const char *end, const TSVFormat *format, TSVChunk *chunk);
+	
+	//numberTSVChunkGenes:
+	//	Interns the genes of chunk and gives the new ones the next nodes, genes maps nodes to gene symbols
+	//	and nodeOf gene symbols to nodes. ids gets the node of each gene of chunk. Chunks must be numbered in
+	//	file order.
+	void numberTSVChunkGenes(TSVChunk &chunk, vector<CSRGraph::NodeId> &nodeOf, vector<SymbolTable::Symbol> &genes, vector<CSRGraph::NodeId> &ids);
+	
+	//turns the links of chunk into pairs of nodes with ids from numberTSVChunkGenes, safe to run concurrently
+	static void renumberTSVChunkLinks(TSVChunk *chunk, const vector<CSRGraph::NodeId> *ids);
+	
+	//buildTSVNetwork: builds net from the numbered links of chunks, a link read again takes the later weight.
+	//	The chunks and genes are left empty.
+	void buildTSVNetwork(vector<TSVChunk> &chunks, vector<SymbolTable::Symbol> &genes, CSRGraph &net);
+	
+	//the layout of a TSV file from its first line, or the one given in columns
+	TSVFormat getTSVFormat(string path);
+	TSVFormat getColumnTSVFormat(string path, string columns);
+	static TSVFormat getSimpleTSVFormat();
+	static TSVFormat getFunCoupTSVFormat();
+	
+	//adds a link that passed the cutoff, the weight is kept only if keepLinkWeights.
+	//A link read again takes the later weight.
+	void addLink(const Graph::Node &v1, const Graph::Node &v2, float weight)
+	{
+		graphPtr->AddLink(v1, v2);
+		if (keepLinkWeights)
+			linkWeights[v1 < v2 ? make_pair(v1, v2) : make_pair(v2, v1)] = weight;
+	}
+	
 	Graph *graphPtr;
 	Graph graph;
+	LinkWeights linkWeights;
 	
 };
 
@@ -31,11 +31,16 @@ various tests that are presented in the paper:
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <thread>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/graph/iteration_macros.hpp>
 
 #include "crosstalkz.h"
+#include "inputstream.h"
+#include "textscan.h"
+#include "groupcollection.h"
+#include "fastrandom.h"
 #include "defines.h"
 
 using namespace std;
@@ -47,17 +52,28 @@ bool useCutoff = false;
 int modeFlag = MODE_0;
 bool allVsall = true;
 int methodFlag = METHOD_DEFAULT;
+int orderFlag = ORDER_DEFAULT;
 int minimumGenesForGroup = 10;
 bool doClusteringCoeff = false;
 bool doHyper = false;
-
-//	the 0th element is the  from origNetwork with gene string
-//	the 1st element is the  from randNetwork with gene string
-map<string, vector<Graph::Node> > geneVertMap; 	
+int matrixMaxNodes = MATRIX_MAX_NODES_DEFAULT;
+double switchesPerLink = LINKSWAP_SWITCHES_DEFAULT;
+int numThreads = 0; //0 until parseArgs sets it to the number of cores
+bool useNetworkCache = true;
+bool useGroupCache = true;
+bool keepLinkWeights = false; //set by parseArgs if the random networks of -w are written
+string networkColumns; //empty unless the network columns are given with -C
+
+SymbolTable geneSymbols;
+SymbolTable groupSymbols;
+const SymbolTable::Symbol SymbolTable::NONE;
+const CSRGraph::NodeId CSRGraph::NONE;
+
+//	maps each gene symbol to its node id in the origNetwork CSRGraph snapshot, CSRGraph::NONE if not in the network
+vector<CSRGraph::NodeId> geneNodeIds; 	
 float minObsLinks = 3;		//not used
 float minExpLinks = 0.3;	//not used
 
-#define DEGREE_BIN(x)		((int)round(log(x)+1))
 #define MIN(a,b) ((a<b)?a:b)
 #define MAX(a,b) ((a>b)?a:b)
 
@@ -78,12 +94,6 @@ long double pHyper(int n, int m, int k, int N){
 	return nCk(m, k)*nCk(N-m, n-k)/nCk(N,n);
 }
 
-void zeroLinks(Graph &network)
-{
-	for (Graph::link_range_t er = network.getLinks(); er.first != er.second; er.first++)
-		network.properties(*er.first).weight = 0;
-}
-
 template<class T1, class T2 >
 bool keyInMap(const T1 &k, const map<T1, T2 > &m)
 {
@@ -102,15 +112,43 @@ float calculateReducedChiSquare(vector<T> &dataSet, const float mean, const floa
 
 bool groupSort(const GeneGroup& g1, const GeneGroup& g2)
 {
-  return (g1.groupId < g2.groupId);
+  return (groupSymbols.getName(g1.groupId) < groupSymbols.getName(g2.groupId));
 }
 
-bool pValueSort(const pair<string, float> &p1, const pair<string, float> &p2)
+bool pValueSort(const pair<int, double> &p1, const pair<int, double> &p2)
 {
   return (p1.second < p2.second);
 }
 
-void writeLog(const Graph &origNet, const Graph &randNet){
+//pairIndexAll:
+//	Index into the groupStats vector of the unordered pair of groups i and j (all vs all).
+inline int pairIndexAll(int i, int j)
+{
+	if (i < j)
+		std::swap(i, j);
+	return i*(i+1)/2 + j;
+}
+
+inline int pairCountAll(int groupCount)
+{
+	return groupCount*(groupCount+1)/2;
+}
+
+//pairIndex12:
+//	Index into the groupStats vector of groups1[i] vs groups2[j] (groups1 vs groups2).
+inline int pairIndex12(int i, int j, int groups2Count)
+{
+	return i*groups2Count + j;
+}
+
+//groupsVsString:
+//	The name of a group pair as written to the results file.
+string groupsVsString(const GeneGroup &g1, const GeneGroup &g2)
+{
+	return groupSymbols.getName(g1.groupId) + "_vs_" + groupSymbols.getName(g2.groupId);
+}
+
+void writeLog(const CSRGraph &origNet, const RandomGraph &randNet){
 	long long s1 = calculateSmetricNetwork(randNet);
 	long long s2 = calculateSmetricNetwork(origNet);
 	cout << "Random network s-metric = " << s1 << endl;
@@ -125,142 +163,144 @@ void writeLog(const Graph &origNet, const Graph &randNet){
 	cout << "Ratio random/original r-metric = " << (double)(r1)/(double)(r2) << endl;
 }
 
-//validateConnectivities:
-//	Checks the node connectivities of the randNet network against the connectivities of the origNet network.
-//	Generates a list of errors sorted by size of differences in increasing order.
-//
-//	origNet: a Graph that contains the network loaded from boostgraphio
-//	randNet: a Graph to compare with origNet
-//	errors: a vector that afterwards contains pairs of vertices of origNet and randNet that 
-//			have different connectivities between origNet and randNet sorted from smallest difference to largest
-//	returns true if randNet has the same connectivities as origNet else false
-bool validateConnectivities(const Graph &origNet, 
-							const Graph &randNet, 
-							vector<pair<Graph::Node, Graph::Node> > &errors);
-
 //fixConnectivityErrors:
 //	Fixes the node connectivities of the randNet network to match connectivities of the origNet network
 //	using the errors found by validateConnectivities
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
-//	randNet: a randomized Graph to fix
-//	errors: a vector containing pairs of vertices of origNet and randNet that 
-//			have different connectivities between origNet and randNet sorted from smallest difference to largest
-void fixConnectivityErrors(const Graph &origNet, 
-						   Graph &randNet, 
-						   vector<pair<Graph::Node, Graph::Node> > &errors);
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
+//	randNet: a randomized RandomGraph to fix
+//	errors: a vector containing the ids of the nodes that have different 
+//			connectivities between origNet and randNet sorted from smallest difference to largest
+void fixConnectivityErrors(const CSRGraph &origNet, 
+						   RandomGraph &randNet, 
+						   vector<CSRGraph::NodeId> &errors);
 
  
 /****************FUNCTION DEFINITIONS****************/
 
 
-void readGeneGroups(const Graph &origNet, vector<GeneGroup> &groups, map<string, vector<string> > &geneGroupMap, string path, stringstream &ss)
+void reorderNetwork(CSRGraph &net, int order, stringstream &ss)
 {
-	ifstream file;
-	string line, currentGroupID, currentGeneID;
-	vector<string> lineVals; 
-	currentGroupID = "";
-	bool geneInNetwork;
-	map<string, int> groupIndexMap;
-	map<string, bool> countNotInNetwork, totalGenesInput;
+	clock_t start = clock();
+	int before = net.getBandwidth();
 	
-	file.open(path.c_str());
-	if (!file)
+	cout << "Reordering nodes...";flush(cout);
+	
+	switch(order)
 	{
-		cout << "Error in opening "<< path << endl;
-		exit(1);
+		case ORDER_DEGREE:
+			net.permute(net.degreeOrder());
+			break;
+		case ORDER_RCM:
+			net.permute(net.rcmOrder());
+			break;
+		default:
+			break;
 	}
 	
-	cout << endl <<"Reading groups from "<< path << " ..." << endl;
+	cout << "done in " << (clock()-start)/(CLOCKS_PER_SEC+0.0) <<" seconds." << endl;
+	
+	ss << "Network bandwidth before reordering: " << before << endl;
+	ss << "Network bandwidth after reordering: " << net.getBandwidth() << endl;
+}
+
+//buildGeneGroupMap:
+//	Sets geneGroupMap to the groups of each node of net, as indexes into groups.
+void buildGeneGroupMap(const CSRGraph &net, const vector<GeneGroup> &groups, GeneGroupMap &geneGroupMap)
+{
+	vector<uint32_t> geneOffsets(geneSymbols.size()+1, 0), geneIds, next;
+	SymbolTable::Symbol gene;
+	CSRGraph::NodeId v;
+	uint32_t k;
+	
+	//the groups of each gene first, groups are visited in order so the indexes come out ascending
+	for (int i = 0; i < (int)groups.size(); i++)
+	for (int j = 0; j < (int)groups[i].groupGenes.size(); j++)
+		geneOffsets[groups[i].groupGenes[j]+1]++;
+	for (k = 0; k < (uint32_t)geneSymbols.size(); k++)
+		geneOffsets[k+1] += geneOffsets[k];
+	next.assign(geneOffsets.begin(), geneOffsets.end()-1);
+	geneIds.resize(geneOffsets.back());
+	for (int i = 0; i < (int)groups.size(); i++)
+	for (int j = 0; j < (int)groups[i].groupGenes.size(); j++)
+		geneIds[next[groups[i].groupGenes[j]]++] = i;
+	
+	//then copied to every node of the gene, there may be several in an XGMML network
+	geneGroupMap.clear();
+	geneGroupMap.narrow = (groups.size() <= NARROW_GROUP_IDS);
+	geneGroupMap.offsets.assign(net.getNodeCount()+1, 0);
+	for (v = 0; v < (CSRGraph::NodeId)net.getNodeCount(); v++)
+	{
+		gene = net.getGeneId(v);
+		geneGroupMap.offsets[v+1] = geneGroupMap.offsets[v] + (gene < (SymbolTable::Symbol)geneSymbols.size() ? geneOffsets[gene+1]-geneOffsets[gene] : 0);
+	}
+	if (geneGroupMap.narrow)
+		geneGroupMap.narrowIds.resize(geneGroupMap.offsets.back());
+	else
+		geneGroupMap.wideIds.resize(geneGroupMap.offsets.back());
+	for (v = 0; v < (CSRGraph::NodeId)net.getNodeCount(); v++)
+	{
+		gene = net.getGeneId(v);
+		for (k = 0; k < (uint32_t)geneGroupMap.getGroupCount(v); k++)
+			if (geneGroupMap.narrow)
+				geneGroupMap.narrowIds[geneGroupMap.offsets[v]+k] = geneIds[geneOffsets[gene]+k];
+			else
+				geneGroupMap.wideIds[geneGroupMap.offsets[v]+k] = geneIds[geneOffsets[gene]+k];
+	}
+	
+	geneGroupMap.groupIndex.assign(groupSymbols.size(), -1);
+	for (int i = 0; i < (int)groups.size(); i++)
+		geneGroupMap.groupIndex[groups[i].groupId] = i;
+}
+
+void readGeneGroups(const CSRGraph &origNet, vector<GeneGroup> &groups, GeneGroupMap &geneGroupMap, string path, stringstream &ss)
+{
+	GroupCollection collection;
+	SymbolTable::Symbol gene;
+	vector<char> geneNotInNetwork, geneKept; //flags by gene symbol
+	int countInput, countNotInNetwork = 0, countKept = 0, kept, k;
+	
+	collection.load(path, useGroupCache);
+	countInput = collection.genes.size();
 
 	groups.clear();
 	geneGroupMap.clear();
-	groupIndexMap.clear();
+	groups.resize(collection.getGroupCount());
+	geneNotInNetwork.assign(geneSymbols.size(), 0);
 	
-	while(getline(file, line))
+	for (k = 0; k < collection.getGroupCount(); k++)
 	{
-		GeneGroup thisGroup;
+		GeneGroup &thisGroup = groups[k];
+		thisGroup.groupId = collection.groupIds[k];
+		thisGroup.groupSpe = collection.groupSpe[k];
+		thisGroup.groupSys = collection.groupSys[k];
+		thisGroup.groupDesc = collection.groupDesc[k];
 		thisGroup.inputFilePath = path;
 		
-		split(lineVals, line, is_any_of(", \t"));
-		for (int c = 0; c < (int)lineVals.size(); c++) //clean out peoples trash.
-			if (lineVals[c] == ""){
-				lineVals.erase(lineVals.begin()+c);
-				c = 0;
-			}
-		if (lineVals.size() < 2)
-			continue;
-		
-		to_upper(lineVals[GROUP_GENE]);
-		to_upper(lineVals[GROUP_ID]);
-		if (lineVals.size() > GROUP_SPE)
-			to_lower(lineVals[GROUP_SPE]);
-		if (lineVals.size() > GROUP_SYS)
-			to_upper(lineVals[GROUP_SYS]);
-			
-		currentGeneID = lineVals[GROUP_GENE];
-		currentGeneID.erase(currentGeneID.find_last_not_of(" \n\r\t")+1);
-		totalGenesInput[currentGeneID] = true;
-		
-		geneInNetwork = (getNodeById(origNet, currentGeneID) != NULL);
-		
-		currentGroupID = lineVals[GROUP_ID];
-		currentGroupID.erase(currentGroupID.find_last_not_of(" \n\r\t")+1);
-		
-		if (lineVals.size() > GROUP_SPE){
-			thisGroup.groupSpe = lineVals[GROUP_SPE];
-			thisGroup.groupSpe.erase(thisGroup.groupSpe.find_last_not_of(" \n\r\t")+1);
-		}
-		if (lineVals.size() > GROUP_SYS){
-			thisGroup.groupSys = lineVals[GROUP_SYS];
-			thisGroup.groupSys.erase(thisGroup.groupSys.find_last_not_of(" \n\r\t")+1);
-		}
-		if (lineVals.size() > GROUP_DESC){
-			thisGroup.groupDesc = lineVals[GROUP_DESC];
-			thisGroup.groupDesc.erase(thisGroup.groupDesc.find_last_not_of("\n\r\t")+1);
-		}
-		
-		thisGroup.groupGenes.clear();
-		
-		if (!keyInMap(currentGroupID, groupIndexMap))
+		for (const uint32_t *m = collection.getMembersBegin(k); m != collection.getMembersEnd(k); m++)
 		{
-			thisGroup.groupId = currentGroupID;
-			groups.push_back(thisGroup);
-			groupIndexMap[currentGroupID] = groups.size()-1;
-		}
-		
-		if(geneInNetwork)
-		{
-			groups[groupIndexMap[currentGroupID]].groupGenes.push_back(currentGeneID);
-			geneGroupMap[currentGeneID].push_back(currentGroupID);
+			gene = collection.genes[*m];
+			if(getNodeById(gene) != CSRGraph::NONE)
+				thisGroup.groupGenes.push_back(gene);
+			else if (!geneNotInNetwork[gene])
+			{
+				geneNotInNetwork[gene] = 1;
+				countNotInNetwork++;
+			}
 		}
-		else
-			countNotInNetwork[currentGeneID] = true;
 	}
-	file.close();
 	
 	int totalGroups =  (int)groups.size();
 	
-	//remove groups from the list that do not meet some requirements
-	for (int i = 0; i < (int)groups.size();)
-		if ((int)groups[i].groupGenes.size() < minimumGenesForGroup) //this is the requirement to remove
+	//remove the groups that do not meet some requirements in one pass, keeping the order of the rest
+	for (k = 0, kept = 0; k < (int)groups.size(); k++)
+		if ((int)groups[k].groupGenes.size() >= minimumGenesForGroup) //this is the requirement to keep
 		{
-			//also need to remove all occurances from the geneGroup Map
-			for (map<string, vector<string> >::iterator it = geneGroupMap.begin(); it != geneGroupMap.end(); it++)
-				for (int j = 0; j < (int)it->second.size();)
-					if (it->second[j] == groups[i].groupId)
-					{
-						it->second.erase(it->second.begin()+j);
-						j = 0;
-					}
-					else
-						j++;
-
-			groups.erase(groups.begin()+i);
-			i = 0;			
+			if (kept != k)
+				groups[kept] = std::move(groups[k]);
+			kept++;
 		}
-		else
-			i++;
+	groups.resize(kept);
 		
 	if (!groups.size())
 	{
@@ -269,19 +309,22 @@ void readGeneGroups(const Graph &origNet, vector<GeneGroup> &groups, map<string,
 	}
 
 	sort(groups.begin(), groups.end(), groupSort);
+	buildGeneGroupMap(origNet, groups, geneGroupMap);
 
-
-	map<string, bool> testUnique;
+	geneKept.assign(geneSymbols.size(), 0);
 	for (int i = 0; i < (int)groups.size(); i++)
 	for (int j = 0; j < (int)groups[i].groupGenes.size(); j++)
-		if(!keyInMap(groups[i].groupGenes[j], testUnique))
-			testUnique[groups[i].groupGenes[j]] = true;
+		if(!geneKept[groups[i].groupGenes[j]])
+		{
+			geneKept[groups[i].groupGenes[j]] = 1;
+			countKept++;
+		}
 
 	ss << "Total number of groups input: " << totalGroups << endl;
-	ss << "Total number of unique genes in the set of groups: " << totalGenesInput.size() << endl;
+	ss << "Total number of unique genes in the set of groups: " << countInput << endl;
 	ss << "Number of groups with at least " << minimumGenesForGroup << " gene members (final number of groups): " << groups.size() << endl;
-	ss << "Number of unique group genes not found in the network: " << countNotInNetwork.size() << endl;
-	ss << "Number of unique genes in the set of groups and in the network: "<< testUnique.size() << endl;
+	ss << "Number of unique group genes not found in the network: " << countNotInNetwork << endl;
+	ss << "Number of unique genes in the set of groups and in the network: "<< countKept << endl;
 
 #if VERBOSE	
 /*	For degree distribution:
@@ -310,83 +353,81 @@ void readGeneGroups(const Graph &origNet, vector<GeneGroup> &groups, map<string,
 }
 
 
-int generateRandomNetworkLinkSwap(const Graph &origNet, Graph &randNet)
+//a link switch drawn for generateRandomNetworkLinkSwap
+struct LinkSwitch
 {
-	vector<Graph::Link> links;
-	LinkProperties link;
-	link.weight = 1.0;
-	
-	for (Graph::link_range_t er = randNet.getLinks(); er.first != er.second; er.first++)
-		links.push_back(*er.first);
-	
-	int randIndex1, randIndex2;
-	bool test;
-	Graph::Node v1, v2, v3, v4;
-	map<string, bool> hasTested; 
-	stringstream ss;
-	int countSwaps = 0;
-	
-	while(hasTested.size()/2 <= links.size() && links.size() >= 2)
+	int k1, k2;	//the links
+	bool turn;	//the ends of k2 are turned around
+};
+
+int generateRandomNetworkLinkSwap(const CSRGraph &origNet, RandomGraph &randNet)
+{
+	//seeded from rand(), so that srand's seed still decides the network
+	FastRandom rng(((uint64_t)rand() << 32) ^ (uint64_t)rand());
+	int linkCount = randNet.getLinkCount();
+	uint64_t attempts = (linkCount >= 2) ? (uint64_t)(switchesPerLink*linkCount) : 0, t;
+	vector<char> switched(linkCount, 0); //links switched at least once
+	LinkSwitch ahead[2*LINKSWAP_PREFETCH]; //the switches t to t+2*LINKSWAP_PREFETCH-1
+	int countSwitched = 0;
+	RandomGraph::NodeId v1, v2, v3, v4;
+	
+	//a Markov chain over the networks with the same degrees: each step picks two links at
+	//random and switches their ends unless that makes a self loop or a link that exists.
+	//The steps are drawn ahead, so the links of a step are loaded while the steps before
+	//it run and its index entries while the LINKSWAP_PREFETCH steps before it run.
+	for (t = 0; t < 2*LINKSWAP_PREFETCH && t < attempts; t++)
 	{
-		do
+		ahead[t].k1 = rng.below(linkCount);
+		ahead[t].k2 = rng.below(linkCount);
+		ahead[t].turn = rng.next() & 1;
+		randNet.prefetchLink(ahead[t].k1);
+		randNet.prefetchLink(ahead[t].k2);
+	}
+	for (t = 0; t < attempts; t++)
+	{
+		if (t+LINKSWAP_PREFETCH < attempts)
 		{
-			randIndex1 = rand()%links.size();
-			randIndex2 = rand()%links.size();
-			
-			randNet.getNodesByLink(links[randIndex1], v1, v2);
-			randNet.getNodesByLink(links[randIndex2], v3, v4);
-	
-			test = (randIndex1 != randIndex2)
-				&& ((!randNet.hasLink(v1, v3) && !randNet.hasLink(v2, v4))
-				|| (!randNet.hasLink(v1, v4) && !randNet.hasLink(v2, v3)))
-				&& v1 != v3 && v2 != v3 && v4 != v1 && v4 != v2;
-			
-			if (!test && (randIndex1 != randIndex2))
-			{
-				ss << randIndex1 << " " << randIndex2;
-				hasTested[ss.str()] = true;
-				ss << randIndex2 << " " << randIndex1;
-				hasTested[ss.str()] = true;
-			}
-			
-			//cout << hasTested.size()/2 << " " << links.size() <<endl;
-		} while (!test && hasTested.size()/2 <= links.size() && links.size()>=2);
+			LinkSwitch &next = ahead[(t+LINKSWAP_PREFETCH) % (2*LINKSWAP_PREFETCH)];
+			randNet.getNodesByLink(next.k1, v1, v2);
+			randNet.getNodesByLink(next.k2, v3, v4);
+			if (next.turn)
+				std::swap(v3, v4);
+			randNet.prefetchIndex(v1, v4);
+			randNet.prefetchIndex(v3, v2);
+			randNet.prefetchIndex(v1, v2);
+			randNet.prefetchIndex(v3, v4);
+		}
 		
-		if (test)
+		LinkSwitch &now = ahead[t % (2*LINKSWAP_PREFETCH)];
+		randNet.getNodesByLink(now.k1, v1, v2);
+		randNet.getNodesByLink(now.k2, v3, v4);
+		//(v1, v2) and (v3, v4) become (v1, v4) and (v3, v2), or with the ends of the second
+		//link turned around (v1, v3) and (v4, v2), both with the same chance
+		if (now.turn)
+			std::swap(v3, v4);
+		
+		//links with a node in common, k1 == k2 too, can not be switched. A link of a node to itself
+		//may be switched away but never made, and two of them would become the same link twice
+		if (v1 != v3 && v1 != v4 && v2 != v3 && v2 != v4 && (v1 != v2 || v3 != v4)
+			&& !randNet.hasLink(v1, v4) && !randNet.hasLink(v3, v2))
 		{
-			if (!randNet.hasLink(v1, v3) && !randNet.hasLink(v2, v4))
-			{
-				randNet.RemoveLink(v1, v2);
-				randNet.RemoveLink(v3, v4);
-				randNet.AddLink(v1, v3, link);
-				randNet.AddLink(v2, v4, link);	
-				countSwaps++;
-			}
-			else if (!randNet.hasLink(v1, v4) && !randNet.hasLink(v2, v3))
-			{
-				randNet.RemoveLink(v1, v2);
-				randNet.RemoveLink(v3, v4);
-				randNet.AddLink(v1, v4, link);
-				randNet.AddLink(v2, v3, link);
-				countSwaps++;
-			}
-			if (randIndex1 > randIndex2)
-			{
-				links.erase(links.begin()+randIndex1);
-				links.erase(links.begin()+randIndex2);
-				hasTested.clear();
-			}
-			else
-			{
-				links.erase(links.begin()+randIndex2);
-				links.erase(links.begin()+randIndex1);
-				hasTested.clear();
-			}
+			randNet.switchLinks(now.k1, now.k2, now.turn);
+			countSwitched += !switched[now.k1] + !switched[now.k2];
+			switched[now.k1] = switched[now.k2] = 1;
+		}
+		
+		if (t+2*LINKSWAP_PREFETCH < attempts)
+		{
+			now.k1 = rng.below(linkCount);
+			now.k2 = rng.below(linkCount);
+			now.turn = rng.next() & 1;
+			randNet.prefetchLink(now.k1);
+			randNet.prefetchLink(now.k2);
 		}
 	}
 	
 #if VERBOSE
-	vector<pair<Graph::Node, Graph::Node> > errors;
+	vector<CSRGraph::NodeId> errors;
 	if(validateConnectivities(origNet, randNet, errors))
 		printf("Conserved connectivity.\n");
 	else
@@ -395,20 +436,21 @@ int generateRandomNetworkLinkSwap(const Graph &origNet, Graph &randNet)
 	writeLog(origNet, randNet);
 #endif
 	
-	return 2*countSwaps;
+	return countSwitched;
 }
 
-bool generateRandomNetworkLabelSwap(const Graph &origNet, Graph &randNet, map<int, vector<Record> > &degRecordsMap)
+bool generateRandomNetworkLabelSwap(const CSRGraph &origNet, RandomGraph &randNet, map<int, vector<Record> > &degRecordsMap)
 {
 	vector<Record> randRecords;
+	CSRGraph::adjacency_node_range_t avr;
 	
 	//create a list of vertices paired with the connectivity 
 	//as in the original network (refered to as records)
-	for (Graph::node_range_t vr = randNet.getNodes(); vr.first != vr.second; vr.first++)
+	for (CSRGraph::NodeId v = 0; v < (CSRGraph::NodeId)origNet.getNodeCount(); v++)
 	{
 		Record record;
-		record.node = *vr.first;
-		record.degree = randNet.getNodeDegree(record.node); //at this point randNet is exact copy of origNet
+		record.node = v;
+		record.degree = origNet.getNodeDegree(v);
 		randRecords.push_back(record);
 	}
 	
@@ -416,18 +458,21 @@ bool generateRandomNetworkLabelSwap(const Graph &origNet, Graph &randNet, map<in
 	random_shuffle(randRecords.begin(), randRecords.end());
 	
 	int randIndex;
-	string swaplabel;
+	vector<RandomGraph::NodeId> &labels = randNet.getLabels();
 	vector<Record> *vec1;
 	for (int k = 0; k < (int)randRecords.size(); k++)
 	{
-		vec1 = &(degRecordsMap[DEGREE_BIN(randRecords[k].degree)]);
+		vec1 = &(degRecordsMap[origNet.getNodeBin(randRecords[k].node)]);
 		randIndex = rand()%(vec1->size());
 		
-		swaplabel = randNet.properties(randRecords[k].node).geneId;
-		
-		randNet.properties(randRecords[k].node).geneId = randNet.properties((*vec1)[randIndex].node).geneId;
-		randNet.properties((*vec1)[randIndex].node).geneId = swaplabel;
+		std::swap(labels[randRecords[k].node], labels[(*vec1)[randIndex].node]);
 	}
+	
+	//the links of the original network between the nodes now carrying the labels
+	randNet.clearLinks();
+	for (CSRGraph::NodeId v1 = 0; v1 < (CSRGraph::NodeId)origNet.getNodeCount(); v1++)
+		for (avr = origNet.getLinkNeighbors(v1); avr.first != avr.second; avr.first++)
+			randNet.addLink(labels[v1], labels[*avr.first]);
 
 #if VERBOSE
 	writeLog(origNet, randNet);
@@ -436,25 +481,23 @@ bool generateRandomNetworkLabelSwap(const Graph &origNet, Graph &randNet, map<in
 	return true;	
 }
 
-bool generateRandomNetworkSecondOrder(const Graph &origNet, Graph &randNet, map<int, vector<Record> > &degRecordsMap)
+bool generateRandomNetworkSecondOrder(const CSRGraph &origNet, RandomGraph &randNet, map<int, vector<Record> > &degRecordsMap)
 {
 	int randNum, randIndex;
 	vector<Record> randRecordsAll, randRecordsAvail;
 	vector<int> randRecordIndices;
-	LinkProperties link;
+	vector<int> connectedDegrees;
 	bool test = true;
-	link.weight = 1.0;
 	
 	cout << "Generating random network... "<<endl;
-	/* NOTE: Assuming that at this point randNet = origNet!!!!! */
 		
 	//create a list of vertices paired with the connectivity 
 	//as in the original network (refered to as records)
-	for (Graph::node_range_t vr = randNet.getNodes(); vr.first != vr.second; vr.first++)
+	for (CSRGraph::NodeId v = 0; v < (CSRGraph::NodeId)origNet.getNodeCount(); v++)
 	{
 		Record record;
-		record.node = *vr.first;
-		record.degree = randNet.getNodeDegree(record.node); //at this point randNet is exact copy of origNet
+		record.node = v;
+		record.degree = origNet.getNodeDegree(v);
 		//record.smetric = calculateSmetricNode(randNet, record.);
 		randRecordsAll.push_back(record);
 	}
@@ -463,13 +506,18 @@ bool generateRandomNetworkSecondOrder(const Graph &origNet, Graph &randNet, map<
 	random_shuffle(randRecordsAll.begin(), randRecordsAll.end());
 	
 	//clear the random network of all links
-	randNet.RemoveAllLinks();
+	randNet.clearLinks();
 	
 	for (int k = 0; k < (int)randRecordsAll.size(); k++)
 	{			
-		for (int j = 0; j < (int)randNet.properties(randRecordsAll[k].node).connectedDegrees.size(); j++)
+		//the degree bins of the neighbors of the node in the original network
+		connectedDegrees.clear();
+		for (CSRGraph::adjacency_node_range_t avr = origNet.getAdjacentNodes(randRecordsAll[k].node); avr.first != avr.second; avr.first++)
+			connectedDegrees.push_back(origNet.getNodeBin(*avr.first));
+		
+		for (int j = 0; j < (int)connectedDegrees.size(); j++)
 		{
-			randRecordsAvail = degRecordsMap[randNet.properties(randRecordsAll[k].node).connectedDegrees[j]];
+			randRecordsAvail = degRecordsMap[connectedDegrees[j]];
 			
 			//generate a list of indices of randRecordsAvail indices
 			randRecordIndices.clear();
@@ -508,7 +556,7 @@ bool generateRandomNetworkSecondOrder(const Graph &origNet, Graph &randNet, map<
 				bool doBreak = false;
 				
 				//add the link to the network
-				randNet.AddLink(randRecordsAll[k].node, randRecordsAvail[randNum].node, link);	
+				randNet.addLink(randRecordsAll[k].node, randRecordsAvail[randNum].node);	
 													
 				//instead of checking all the records, only check two (the extra case is if k < randNum and k is removed)
 				if (randRecordsAll[k].degree == randNet.getNodeDegree(randRecordsAll[k].node))
@@ -537,7 +585,7 @@ bool generateRandomNetworkSecondOrder(const Graph &origNet, Graph &randNet, map<
 	}//end for k	
 
 	//validate and fix the connectivity errors
-	vector<pair<Graph::Node, Graph::Node> > errors;
+	vector<CSRGraph::NodeId> errors;
 	if (!validateConnectivities(origNet, randNet, errors))
 		fixConnectivityErrors(origNet, randNet, errors);
 
@@ -552,37 +600,34 @@ bool generateRandomNetworkSecondOrder(const Graph &origNet, Graph &randNet, map<
 	
 #if DEBUG
 	for (int i = 0; i < (int)errors.size(); i++)
-		printf("error %d has %d in orig and %d in rand\n", i, origNet.getNodeDegree(errors[i].first), randNet.getNodeDegree(errors[i].second));
+		printf("error %d has %d in orig and %d in rand\n", i, origNet.getNodeDegree(errors[i]), randNet.getNodeDegree(errors[i]));
 #endif
 
 	int sum = 0;
 	for (int i = 0; i < (int)errors.size(); i++)
-		sum += (int)abs(origNet.getNodeDegree(errors[i].first) - randNet.getNodeDegree(errors[i].second));	
+		sum += (int)abs(origNet.getNodeDegree(errors[i]) - randNet.getNodeDegree(errors[i]));	
 	printf("***Warning*** Randomization failed to conserve connectivities.\n");
 	printf("***Warning*** There was a difference of %d links between the original and randomized network\n", sum);
 
 	return false;
 }
 
-bool generateRandomNetworkAssignment(const Graph &origNet, Graph &randNet)
+bool generateRandomNetworkAssignment(const CSRGraph &origNet, RandomGraph &randNet)
 {
 	int randNum, randIndex, numToGo;
-	vector<pair<Graph::Node, int> > randRecords;
+	vector<pair<RandomGraph::NodeId, int> > randRecords;
 	vector<int> randRecordIndices;
-	LinkProperties link;
 	bool test = true, doBreak = false;
 	
 	cout << "Generating random network... "<<endl;
 
-	link.weight = 1.0;
-			
 	//create a list of vertices paired with the connectivity 
 	//as in the original network (refered to as records)
-	for (Graph::node_range_t vr = randNet.getNodes(); vr.first != vr.second; vr.first++)
+	for (CSRGraph::NodeId v = 0; v < (CSRGraph::NodeId)origNet.getNodeCount(); v++)
 	{
-		pair<Graph::Node, int> record;
-		record.first = *vr.first;
-		record.second = randNet.getNodeDegree(record.first); //at this point randNet is exact copy of origNet
+		pair<RandomGraph::NodeId, int> record;
+		record.first = v;
+		record.second = origNet.getNodeDegree(v);
 		randRecords.push_back(record);
 	}
    
@@ -590,7 +635,7 @@ bool generateRandomNetworkAssignment(const Graph &origNet, Graph &randNet)
 	random_shuffle(randRecords.begin(), randRecords.end());
 				
 	//clear the random network of all links
-	randNet.RemoveAllLinks();
+	randNet.clearLinks();
 	
 	for (int k = 0; k < (int)randRecords.size();) //k++ below
 	{		
@@ -634,7 +679,7 @@ bool generateRandomNetworkAssignment(const Graph &origNet, Graph &randNet)
 			if (!test) 
 			{
 				//add the link to the network
-				randNet.AddLink(randRecords[k].first, randRecords[randNum].first, link);	
+				randNet.addLink(randRecords[k].first, randRecords[randNum].first);	
 													
 				//instead of checking all the records, only check two (the extra case is if k < randNum and k is removed)
 				if (randRecords[k].second == randNet.getNodeDegree(randRecords[k].first))
@@ -672,7 +717,7 @@ bool generateRandomNetworkAssignment(const Graph &origNet, Graph &randNet)
 	}//end for k	
 
 	//validate and fix the connectivity errors
-	vector<pair<Graph::Node, Graph::Node> > errors;
+	vector<CSRGraph::NodeId> errors;
 	if (!validateConnectivities(origNet, randNet, errors))
 		fixConnectivityErrors(origNet, randNet, errors);
 
@@ -687,12 +732,12 @@ bool generateRandomNetworkAssignment(const Graph &origNet, Graph &randNet)
 #if DEBUG
 	for (int i = 0; i < (int)errors.size(); i++)
 		printf("error %d has %d in orig and %d in rand\n", i, 
-			origNet.getNodeDegree(errors[i].first), randNet.getNodeDegree(errors[i].second));
+			origNet.getNodeDegree(errors[i]), randNet.getNodeDegree(errors[i]));
 #endif
 
 	int sum = 0;
 	for (int i = 0; i < (int)errors.size(); i++)
-		sum += (int)abs(origNet.getNodeDegree(errors[i].first) - randNet.getNodeDegree(errors[i].second));	
+		sum += (int)abs(origNet.getNodeDegree(errors[i]) - randNet.getNodeDegree(errors[i]));	
 	printf("***Warning*** Randomization failed to conserve connectivities.\n");
 	printf("***Warning*** There was a difference of %d links between the original and randomized network\n", sum);
 	
@@ -700,18 +745,12 @@ bool generateRandomNetworkAssignment(const Graph &origNet, Graph &randNet)
 }
 
 
-void fixConnectivityErrors(const Graph &origNet, Graph &randNet, 
-				vector<pair<Graph::Node, Graph::Node> > &errors)
+void fixConnectivityErrors(const CSRGraph &origNet, RandomGraph &randNet, 
+				vector<CSRGraph::NodeId> &errors)
 {
-	int numToGo;
-	Graph::Node v1=NULL, v2=NULL;
-	Graph::link_range_t er;
-	Graph::link_iter lastLink;
-	LinkProperties link;
+	int numToGo, k = 0;
+	RandomGraph::NodeId v1 = 0, v2 = 0;
 	bool test = false;
-			
-	link.weight = 1.0;
-
 
 	//This algorithm has two parts. 
 	//First, look for nodes that have an odd number of connectivity errors. (There should be an even number of these)
@@ -720,6 +759,7 @@ void fixConnectivityErrors(const Graph &origNet, Graph &randNet,
 	//and use the other node to connect to the next node in errors that has odd connectivity error.	 
 	//Second, after the odd errors are fixed, it fixes the even connectivity errors by finding sufficient links
 	//to break and adding both links to the node with even errors until it has the correct connectivity.
+	//A broken link is replaced in place by the first of the two new links.
 
 #if VERBOSE	
 	cout << "error size: " << errors.size() << endl;
@@ -728,52 +768,45 @@ void fixConnectivityErrors(const Graph &origNet, Graph &randNet,
 	//this case fixes all of the odd numbered links first
 	for (int i = 0; i < (int)errors.size(); i++)
 	{
-		numToGo = origNet.getNodeDegree(errors[i].first) - randNet.getNodeDegree(errors[i].second);
+		numToGo = origNet.getNodeDegree(errors[i]) - randNet.getNodeDegree(errors[i]);
 		if (numToGo % 2 == 1)
 		{
 			int nextOdd = -1;
-			for (int k = i+1; k < (int)errors.size(); k++)
-				if ((origNet.getNodeDegree(errors[k].first) - randNet.getNodeDegree(errors[k].second)) % 2 == 1)
-					nextOdd = k;
+			for (int n = i+1; n < (int)errors.size(); n++)
+				if ((origNet.getNodeDegree(errors[n]) - randNet.getNodeDegree(errors[n])) % 2 == 1)
+					nextOdd = n;
 			
 			if (nextOdd == -1) //should not happen, just for safety. 
 				break;
 			  
-			er = randNet.getLinks();
-			for (; er.first != er.second; )
+			test = false;
+			for (k = 0; k < randNet.getLinkCount(); )
 			{
-				randNet.getNodesByLink(*er.first, v1, v2);
+				randNet.getNodesByLink(k, v1, v2);
 			
 				test = (randNet.getNodeDegree(v1)%2 == 1) || (randNet.getNodeDegree(v2)%2 == 1);
-				test = test && ((v1 != errors[i].second && v2 != errors[nextOdd].second) && (v1 != errors[nextOdd].second && v2 != errors[i].second));
-				test = test && (((!randNet.hasLink(v1, errors[i].second) && !randNet.hasLink(v2, errors[nextOdd].second)) || (!randNet.hasLink(v1, errors[nextOdd].second) && !randNet.hasLink(v2, errors[i].second))));
+				test = test && ((v1 != errors[i] && v2 != errors[nextOdd]) && (v1 != errors[nextOdd] && v2 != errors[i]));
+				test = test && (((!randNet.hasLink(v1, errors[i]) && !randNet.hasLink(v2, errors[nextOdd])) || (!randNet.hasLink(v1, errors[nextOdd]) && !randNet.hasLink(v2, errors[i]))));
 				
-				er.first++;
+				k++;
 				if (test)
 					break;
 			}
-			//	cout << randNet.properties(v1).geneId << " " << randNet.getNodeDegree(v1) << endl;
-			//	cout << randNet.properties(v2).geneId << " " << randNet.getNodeDegree(v2) << endl;
 
 			// in this case there will always be an even number of errors with 
 			// odd numbers of connections
 			if (test)
 			{
-				bool didAdd = false;
-				if (!randNet.hasLink(v1, errors[i].second) && !randNet.hasLink(v2, errors[nextOdd].second))
+				if (!randNet.hasLink(v1, errors[i]) && !randNet.hasLink(v2, errors[nextOdd]))
 				{
-					randNet.AddLink(v1, errors[i].second, link, link);
-					randNet.AddLink(v2, errors[nextOdd].second, link, link);
-					didAdd = true;
+					randNet.setLink(k-1, v1, errors[i]);
+					randNet.addLink(v2, errors[nextOdd]);
 				}
-				else if (!randNet.hasLink(v2, errors[i].second) && !randNet.hasLink(v1, errors[nextOdd].second))
+				else if (!randNet.hasLink(v2, errors[i]) && !randNet.hasLink(v1, errors[nextOdd]))
 				{
-					randNet.AddLink(v2, errors[i].second, link, link);
-					randNet.AddLink(v1, errors[nextOdd].second, link, link);
-					didAdd = true;
+					randNet.setLink(k-1, v2, errors[i]);
+					randNet.addLink(v1, errors[nextOdd]);
 				}
-				if (didAdd)
-					randNet.RemoveLink(v1, v2);
 			}//end if test
 		}//end if odd
 	}
@@ -787,29 +820,29 @@ void fixConnectivityErrors(const Graph &origNet, Graph &randNet,
 	//this case fixes all of the even ones.
 	for (int i = 0; i < (int)errors.size(); i++)
 	{
-		numToGo = origNet.getNodeDegree(errors[i].first) - randNet.getNodeDegree(errors[i].second);
+		numToGo = origNet.getNodeDegree(errors[i]) - randNet.getNodeDegree(errors[i]);
 		//at this point numToGo should be even
 		for (int j = 0; j < (numToGo/2); j++)
 		{
-			if (j == 0) er = randNet.getLinks();
-			for (; er.first != er.second;)
+			if (j == 0) k = 0;
+			test = false;
+			for (; k < randNet.getLinkCount();)
 			{
-				randNet.getNodesByLink((*er.first), v1, v2);
-				test = (v1 != errors[i].second 
-					 && v2 != errors[i].second
-					 && !randNet.hasLink(v1, errors[i].second)
-					 && !randNet.hasLink(v2, errors[i].second));
+				randNet.getNodesByLink(k, v1, v2);
+				test = (v1 != errors[i] 
+					 && v2 != errors[i]
+					 && !randNet.hasLink(v1, errors[i])
+					 && !randNet.hasLink(v2, errors[i]));
 				
-				er.first++;				
+				k++;				
 				if (test)
 					break;
 			}
 			
 			if (test)
 			{
-				randNet.RemoveLink(v1, v2);
-				randNet.AddLink(v1, errors[i].second, link, link);
-				randNet.AddLink(v2, errors[i].second, link, link);
+				randNet.setLink(k-1, v1, errors[i]);
+				randNet.addLink(v2, errors[i]);
 			}
 		}
 	}
@@ -819,269 +852,349 @@ void fixConnectivityErrors(const Graph &origNet, Graph &randNet,
 
 }
 
-bool validateConnectivities(const Graph &origNet, const Graph &randNet, 
-				vector<pair<Graph::Node, Graph::Node> > &errors)
+bool validateConnectivities(const CSRGraph &origNet, const RandomGraph &randNet, 
+				vector<CSRGraph::NodeId> &errors)
 {
 	bool valid = true;
-	Graph::Node v1, v2;
 
 	errors.clear();
-	for (Graph::node_range_t vp1 = origNet.getNodes(), vp2 = randNet.getNodes(); vp1.first != vp1.second && vp2.first != vp2.second; )
+	for (CSRGraph::NodeId v1 = 0; v1 < (CSRGraph::NodeId)origNet.getNodeCount() && v1 < (CSRGraph::NodeId)randNet.getNodeCount(); v1++)
 	{
-		v1 = *vp1.first;
-		v2 = *vp2.first;
-		if (origNet.properties(v1).geneId != randNet.properties(v2).geneId)
-		{
-			valid = false;
-			printf("Error: node mismatch %s in orig is %s in rand\n", origNet.properties(v1).geneId.c_str(), randNet.properties(v2).geneId.c_str());
-			printf("This should never happen...\n");
-			exit(1);
-		}
-		if (origNet.getNodeDegree(v1) != randNet.getNodeDegree(v2))
+		if (origNet.getNodeDegree(v1) != randNet.getNodeDegree(v1))
 		{
 			int i = 0;
-			pair<Graph::Node, Graph::Node> thisPair;
-			thisPair.first = v1;
-			thisPair.second = v2;
 			//sort the errors by increasing difference in connectivity from original network
 			if (errors.size())
 				for (i = 0; i < (int)errors.size(); i++)
-					if (origNet.getNodeDegree(errors[i].first) - randNet.getNodeDegree(errors[i].second) >
-						origNet.getNodeDegree(v1) - randNet.getNodeDegree(v2))
+					if (origNet.getNodeDegree(errors[i]) - randNet.getNodeDegree(errors[i]) >
+						origNet.getNodeDegree(v1) - randNet.getNodeDegree(v1))
 							break;
 						
-			errors.insert(errors.begin()+i, thisPair);
+			errors.insert(errors.begin()+i, v1);
 			valid = false;
 		}
-		vp1.first++; 
-		vp2.first++;
 	}
 #if VERBOSE	
 	for (int i = 0; i < (int)errors.size(); i++)
 	{	
 		printf("Error %d has %d in orig and %d in rand, delta = %d\n", i, 
-		origNet.getNodeDegree(errors[i].first), randNet.getNodeDegree(errors[i].second), 
-		origNet.getNodeDegree(errors[i].first)-randNet.getNodeDegree(errors[i].second));
+		origNet.getNodeDegree(errors[i]), randNet.getNodeDegree(errors[i]), 
+		origNet.getNodeDegree(errors[i])-randNet.getNodeDegree(errors[i]));
 	}
 #endif		
 
 	return (valid && (origNet.getNodeCount() == randNet.getNodeCount()) && (origNet.getLinkCount() == randNet.getLinkCount()));
 }
 
-bool getTest(vector<string> *ggmp1, const string &g1, const int &p1s, vector<string> *ggmp2, const string &g2, const int &p2s)
+//getTest:
+//	True if the link from a gene in group g1 to a gene in group g2, g1 != g2, is not counted.
+//	g2InP1: the gene in g1 is in g2 too, g1InP2: the gene in g2 is in g1 too.
+inline bool getTest(bool g2InP1, bool g1InP2)
 {
-	bool test = false;
-	int k;
 	switch (modeFlag)
 	{
-		//this code could be simplified, but it might be confusing
 		default:
 		case MODE_0:
 			//if either gene is in both groups, dont count
-			for (k = 0; k < p1s; k++)
-				if ((*ggmp1)[k] == g2)
-				{
-					test = true;
-					break;
-				}
-			if (!test)
-			for (k = 0; k < p2s; k++)
-				if ((*ggmp2)[k] == g1)
-				{
-					test = true;
-					break;
-				}	
-			break;
+			return g2InP1 || g1InP2;
 		case MODE_1:
-			//if both genes are in both groups, dont count
-			for (k = 0; k < p1s; k++)
-				if ((*ggmp1)[k] == g2)
-				{
-					test = true;
-					break;
-				}
-			for (k = 0; k < p2s; k++)
-				if ((*ggmp2)[k] == g1)
-				{
-					test = (test && true);
-					break;
-				}	
-			break;
+			//if both genes are in both groups, dont count. Tests both, so that the count
+			//does not depend on the order of the two genes of a link (see README, CHANGES)
+			return g2InP1 && g1InP2;
 	}
-	return test;
 }
 
+//the group of index g in groups2 as an index into groups1, same maps them, NULL if they are one collection
+inline int sameGroup(uint32_t g, const int *same)
+{
+	return same ? same[g] : (int)g;
+}
 
-void countLinksForGroupsAll(Graph &randNet,
-				vector<GeneGroup> &groups,
-				map<string, Stats > &groupStats,
-				map<string, vector<string> > &geneGroupMap) 
+//countLinkGroups:
+//	Adds a link from a gene in the groups1 [s1, s1+n1) to a gene in the groups2 [s2, s2+n2) to the 
+//	current iteration's link count of every group pair it joins. Both ranges are ascending group indexes.
+//	same maps groups2 indexes to groups1 ones (-1 for none), NULL with groups2Count 0 for the all 
+//	vs all comparison. shared is scratch space.
+template<typename Id1, typename Id2>
+inline void countLinkGroups(const Id1 *s1, int n1, const Id2 *s2, int n2, const int *same,
+				vector<Stats> &groupStats, int groups2Count, vector<char> &shared)
 {
-	Graph::Node v1, v2;
-	string groupsVsStr, p1, p2, g1, g2;
-	Stats *thisGroupStats;
-	vector<string> *ggmp1, *ggmp2; //using these pointras for speed optimization
-	int p1s, p2s;
+	char *in1, *in2;
+	int i, j, k, g;
 	
-	clock_t start = clock();
-
-	cout << "Counting links between groups...";flush(cout);
+	if (!n1 || !n2)
+		return;
+	shared.assign(n1+n2, 0);
+	in1 = &shared[0]; //in1[i]: the second gene is in group s1[i] too
+	in2 = in1+n1; //in2[j]: the first gene is in group s2[j] too
 	
-	for (int i = 0; i < (int)groups.size(); i++)
-		for (int j = 0; j <= i; j++)
+	//one merge of the two ranges finds the groups of both genes, same keeps the order of groups2
+	for (i = 0, j = 0; i < n1 && j < n2;)
+	{
+		g = sameGroup(s2[j], same);
+		if (g < (int)s1[i])
+			j++;
+		else if ((int)s1[i] < g)
+			i++;
+		else
 		{
-			groupsVsStr = groups[i].groupId + "_vs_" + groups[j].groupId;
-			groupStats[groupsVsStr].linkCount.push_back(0);
-			/*if (doClusteringCoeff)
-			{
-				groupStats[groupsVsStr].clusteringCoeff.push_back(	
-				calculateClusteringCoeffForTwoGroups(randNet, groups[i], groups[j]));
-			}*/
+			for (k = i; k < n1 && s1[k] == s1[i]; k++)
+				in1[k] = 1;
+			i = k;
+			for (k = j; k < n2 && s2[k] == s2[j]; k++)
+				in2[k] = 1;
+			j = k;
 		}
+	}
 	
-	for (Graph::link_range_t er = randNet.getLinks(); er.first != er.second; er.first++)
-	{
-		randNet.getNodesByLink((*er.first), v1, v2);
-		
-		p1 = randNet.properties(v1).geneId;
-		p2 = randNet.properties(v2).geneId;
-		
-		ggmp1 = &(geneGroupMap[p1]);
-		ggmp2 = &(geneGroupMap[p2]);
-				
-		p1s = ggmp1->size();
-		p2s = ggmp2->size();
-		
-		for (int i = 0; i < p1s; i++)
-		{
-			g1 = (*ggmp1)[i];
-			
-			for (int j = 0; j < p2s; j++)
+	for (i = 0; i < n1; i++)
+		for (j = 0; j < n2; j++)
+			if (sameGroup(s2[j], same) == (int)s1[i] || !getTest(in2[j], in1[i])) //the same group or different groups
 			{
-				g2 = (*ggmp2)[j];
-				
-				if (g1 >= g2)
-					groupsVsStr = g1 + "_vs_" + g2;
-				else
-					groupsVsStr = g2 + "_vs_" + g1;
+				Stats &thisGroupStats = groupStats[groups2Count ? pairIndex12(s1[i], s2[j], groups2Count) : pairIndexAll(s1[i], s2[j])];
+				thisGroupStats.linkCount[thisGroupStats.linkCount.size()-1] += 1;
+			}
+}
+
+//the group indexes of node v in geneGroupMap
+template<typename Id>
+inline const Id* getGroupIds(const GeneGroupMap &geneGroupMap, CSRGraph::NodeId v);
+
+template<>
+inline const uint16_t* getGroupIds<uint16_t>(const GeneGroupMap &geneGroupMap, CSRGraph::NodeId v)
+{
+	return geneGroupMap.narrowIds.data()+geneGroupMap.offsets[v];
+}
 
-				thisGroupStats = &(groupStats[groupsVsStr]);
+template<>
+inline const uint32_t* getGroupIds<uint32_t>(const GeneGroupMap &geneGroupMap, CSRGraph::NodeId v)
+{
+	return geneGroupMap.wideIds.data()+geneGroupMap.offsets[v];
+}
+
+//forEachLink:
+//	Calls f(v1, v2) once for each link in links, or for each link of net if links is NULL.
+template<typename F>
+inline void forEachLink(const CSRGraph &net, const LinkList *links, F f)
+{
+	CSRGraph::adjacency_node_range_t avr;
 	
-				//if (keyInMap(groupsVsStr, groupStats))
-				{
-					if (g2 == g1) //same group
-						thisGroupStats->linkCount[thisGroupStats->linkCount.size()-1] += 1;
-					else //different groups
-					{
-						if (!getTest(ggmp1, g1, p1s, ggmp2, g2, p2s))
-							thisGroupStats->linkCount[thisGroupStats->linkCount.size()-1] += 1;		
-					}
-				}
+	if (links)
+	{
+		for (LinkList::const_iterator it = links->begin(); it != links->end(); it++)
+			f(it->first, it->second);
+		return;
+	}
+	//each link is visited once, from its endpoint with the lower id
+	for (CSRGraph::NodeId v1 = 0; v1 < (CSRGraph::NodeId)net.getNodeCount(); v1++)
+		for (avr = net.getLinkNeighbors(v1); avr.first != avr.second; avr.first++)
+			f(v1, *avr.first);
+}
+
+template<typename Id>
+void countLinksAll(const CSRGraph &net, const LinkList *links, vector<Stats> &groupStats, const GeneGroupMap &geneGroupMap)
+{
+	vector<char> shared;
+	
+	forEachLink(net, links, [&](CSRGraph::NodeId v1, CSRGraph::NodeId v2){
+		countLinkGroups(getGroupIds<Id>(geneGroupMap, v1), geneGroupMap.getGroupCount(v1),
+			getGroupIds<Id>(geneGroupMap, v2), geneGroupMap.getGroupCount(v2), (const int*)NULL, groupStats, 0, shared);
+	});
+}
+
+//counts each link in both directions, groups1 of v1 to groups2 of v2 and groups1 of v2 to groups2 of v1
+template<typename Id1, typename Id2>
+void countLinks12(const CSRGraph &net, const LinkList *links, vector<Stats> &groupStats, 
+				const GeneGroupMap &geneGroupMap1, const GeneGroupMap &geneGroupMap2, const vector<int> &same)
+{
+	vector<char> shared;
+	int groups2Count = same.size();
+	
+	forEachLink(net, links, [&](CSRGraph::NodeId v1, CSRGraph::NodeId v2){
+		countLinkGroups(getGroupIds<Id1>(geneGroupMap1, v1), geneGroupMap1.getGroupCount(v1),
+			getGroupIds<Id2>(geneGroupMap2, v2), geneGroupMap2.getGroupCount(v2), same.data(), groupStats, groups2Count, shared);
+		countLinkGroups(getGroupIds<Id1>(geneGroupMap1, v2), geneGroupMap1.getGroupCount(v2),
+			getGroupIds<Id2>(geneGroupMap2, v1), geneGroupMap2.getGroupCount(v1), same.data(), groupStats, groups2Count, shared);
+	});
+}
+
+//countSharedRows:
+//	The rows first, first+step, ... of countSharedGenes. groupsOfGene2 lists the groups2 indexes of
+//	each gene symbol at [geneOffsets[g], geneOffsets[g+1]), ascending.
+static void countSharedRows(const vector<GeneGroup> *groups1, const vector<uint32_t> *geneOffsets, const vector<uint32_t> *groupsOfGene2,
+				int groups2Count, bool all, int first, int step, vector<int> *kSuccess)
+{
+	vector<int> shared(groups2Count, 0); //shared genes of group i and each group of groups2
+	vector<int> touched; //the groups2 groups with shared genes
+	uint32_t k, j;
+	
+	for (int i = first; i < (int)groups1->size(); i += step)
+	{
+		const vector<SymbolTable::Symbol> &genes = (*groups1)[i].groupGenes;
+		for (int g = 0; g < (int)genes.size(); g++)
+			for (k = (*geneOffsets)[genes[g]]; k < (*geneOffsets)[genes[g]+1]; k++)
+			{
+				j = (*groupsOfGene2)[k];
+				if (all && (int)j > i) //the pair j, i is done by row j
+					break;
+				if (!shared[j]++)
+					touched.push_back(j);
 			}
+		for (int t = 0; t < (int)touched.size(); t++)
+		{
+			(*kSuccess)[all ? pairIndexAll(i, touched[t]) : pairIndex12(i, touched[t], groups2Count)] = shared[touched[t]];
+			shared[touched[t]] = 0;
 		}
+		touched.clear();
 	}
+}
+
+//countSharedGenes:
+//	Sets kSuccess of every group pair to the genes the two groups share, as the all pairs comparison
+//	of a gene in both groups would count them. Only the pairs sharing genes are visited: each group of
+//	groups1 walks the groups2 groups of its genes. The rows are split over numThreads threads.
+//	all: groups2 is groups1 and kSuccess is indexed by pairIndexAll, else by pairIndex12
+void countSharedGenes(const vector<GeneGroup> &groups1, const vector<GeneGroup> &groups2, bool all, vector<int> &kSuccess)
+{
+	vector<uint32_t> geneOffsets(geneSymbols.size()+1, 0), groupsOfGene2, next;
+	vector<std::thread> threads;
+	int threadCount = MIN(MAX(numThreads, 1), MAX((int)groups1.size(), 1));
+	
+	//the groups of each gene, in group order
+	for (int j = 0; j < (int)groups2.size(); j++)
+	for (int g = 0; g < (int)groups2[j].groupGenes.size(); g++)
+		geneOffsets[groups2[j].groupGenes[g]+1]++;
+	for (int k = 0; k < geneSymbols.size(); k++)
+		geneOffsets[k+1] += geneOffsets[k];
+	next.assign(geneOffsets.begin(), geneOffsets.end()-1);
+	groupsOfGene2.resize(geneOffsets.back());
+	for (int j = 0; j < (int)groups2.size(); j++)
+	for (int g = 0; g < (int)groups2[j].groupGenes.size(); g++)
+		groupsOfGene2[next[groups2[j].groupGenes[g]]++] = j;
+	
+	//rows are dealt round robin, the rows of the all pairs triangle grow with i
+	for (int t = 1; t < threadCount; t++)
+		threads.push_back(std::thread(countSharedRows, &groups1, &geneOffsets, &groupsOfGene2, (int)groups2.size(), all, t, threadCount, &kSuccess));
+	countSharedRows(&groups1, &geneOffsets, &groupsOfGene2, groups2.size(), all, 0, threadCount, &kSuccess);
+	for (int t = 0; t < (int)threads.size(); t++)
+		threads[t].join();
+}
+
+void initLinkCountsAll(vector<GeneGroup> &groups, vector<Stats> &groupStats)
+{
+	groupStats.resize(pairCountAll(groups.size()));
+	for (int i = 0; i < (int)groupStats.size(); i++)
+		groupStats[i].linkCount.push_back(0);
+	/*if (doClusteringCoeff)
+	{
+		groupStats[pairIndexAll(i, j)].clusteringCoeff.push_back(	
+		calculateClusteringCoeffForTwoGroups(randNet, groups[i], groups[j]));
+	}*/
+}
+
+void initLinkCounts12(vector<GeneGroup> &groups1, vector<GeneGroup> &groups2, vector<Stats> &groupStats)
+{
+	groupStats.resize(groups1.size()*groups2.size());
+	for (int i = 0; i < (int)groupStats.size(); i++)
+		groupStats[i].linkCount.push_back(0);
+	/*if (doClusteringCoeff)
+	{
+		groupStats[pairIndex12(i, j, groups2.size())].clusteringCoeff.push_back(	
+		calculateClusteringCoeffForTwoGroups(randNet, groups1[i], groups2[j]));
+	}*/
+}
+
+//counts the links in links, or the links of net if links is NULL
+void countLinksForGroupsAll(const CSRGraph &net,
+				const LinkList *links,
+				vector<GeneGroup> &groups,
+				vector<Stats> &groupStats,
+				GeneGroupMap &geneGroupMap) 
+{
+	clock_t start = clock();
+
+	cout << "Counting links between groups...";flush(cout);
+	
+	initLinkCountsAll(groups, groupStats);
+	
+	if (geneGroupMap.narrow)
+		countLinksAll<uint16_t>(net, links, groupStats, geneGroupMap);
+	else
+		countLinksAll<uint32_t>(net, links, groupStats, geneGroupMap);
 		
 	cout << "done in " << (clock()-start)/(CLOCKS_PER_SEC+0.0) <<" seconds." << endl;
 }
 
-void countLinksForGroups12(Graph &randNet,
+void countLinksForGroupsAll(const CSRGraph &net,
+				const LinkList &links,
+				vector<GeneGroup> &groups,
+				vector<Stats> &groupStats,
+				GeneGroupMap &geneGroupMap) 
+{
+	countLinksForGroupsAll(net, &links, groups, groupStats, geneGroupMap);
+}
+
+void countLinksForGroupsAll(const CSRGraph &net,
+				vector<GeneGroup> &groups,
+				vector<Stats> &groupStats,
+				GeneGroupMap &geneGroupMap) 
+{
+	countLinksForGroupsAll(net, NULL, groups, groupStats, geneGroupMap);
+}
+
+//counts the links in links, or the links of net if links is NULL
+void countLinksForGroups12(const CSRGraph &net,
+								const LinkList *links,
 								vector<GeneGroup> &groups1,
 								vector<GeneGroup> &groups2,
-								map<string, Stats > &groupStats,
-								map<string, vector<string> > &geneGroupMap1,
-								map<string, vector<string> > &geneGroupMap2) 
+								vector<Stats> &groupStats,
+								GeneGroupMap &geneGroupMap1,
+								GeneGroupMap &geneGroupMap2) 
 {
-	Graph::Node v1, v2;
-	string groupsVsStr, p1, p2, g1, g2;
-	Stats *thisGroupStats;
-	vector<string> *ggmp1, *ggmp2;
-	int p1s, p2s;
-	
+	vector<int> same(groups2.size(), -1); //groups2 index -> index of the groups1 group of the same name
 	clock_t start = clock();
 
 	cout << "Counting links between groups...";flush(cout);
 	
-	for (int i = 0; i < (int)groups1.size(); i++)
-		for (int j = 0; j < (int)groups2.size(); j++)
-		{
-			groupsVsStr = groups1[i].groupId + "_vs_" + groups2[j].groupId;
-			groupStats[groupsVsStr].linkCount.push_back(0);
-			/*if (doClusteringCoeff)
-			{
-				groupStats[groupsVsStr].clusteringCoeff.push_back(	
-				calculateClusteringCoeffForTwoGroups(randNet, groups1[i], groups2[j]));
-			}*/
-
-		}
+	initLinkCounts12(groups1, groups2, groupStats);
 	
-	for (Graph::link_range_t er = randNet.getLinks(); er.first != er.second; er.first++)
-	{
-		randNet.getNodesByLink((*er.first), v1, v2);
-		
-		p1 = randNet.properties(v1).geneId;
-		p2 = randNet.properties(v2).geneId;
-		
-		bool p11 = keyInMap(p1, geneGroupMap1);
-		bool p12 = keyInMap(p1, geneGroupMap2);
-		bool p21 = keyInMap(p2, geneGroupMap1);
-		bool p22 = keyInMap(p2, geneGroupMap2);
-		
-		if (p11 && p22)
-		{
-			ggmp1 = &(geneGroupMap1[p1]);
-			ggmp2 = &(geneGroupMap2[p2]);
-			p1s = ggmp1->size();
-			p2s = ggmp2->size();
-			
-			for (int i = 0; i < p1s; i++)
-				for (int j = 0; j < p2s; j++)
-				{
-					g1 = (*ggmp1)[i];
-					g2 = (*ggmp2)[j];
-					
-					groupsVsStr = g1 + "_vs_" + g2;
-					thisGroupStats = &(groupStats[groupsVsStr]);
-			
-					if (g2 == g1) //same group
-						thisGroupStats->linkCount[thisGroupStats->linkCount.size()-1] += 1;
-					else //different groups
-					{
-						if (!getTest(ggmp1, g1, p1s, ggmp2, g2, p2s))
-							thisGroupStats->linkCount[thisGroupStats->linkCount.size()-1] += 1;
-					}
-				}		
-		}
-		
-		if (p12 && p21)
-		{
-			ggmp1 = &(geneGroupMap1[p2]);
-			ggmp2 = &(geneGroupMap2[p1]);
-			p1s = ggmp1->size();
-			p2s = ggmp2->size();
-			
-			for (int i = 0; i < p1s; i++)
-				for (int j = 0; j < p2s; j++)
-				{
-					g1 = (*ggmp1)[i];
-					g2 = (*ggmp2)[j];
-					
-					groupsVsStr = g1 + "_vs_" + g2;
-					thisGroupStats = &(groupStats[groupsVsStr]);
-			
-					if (g2 == g1) //same group
-						thisGroupStats->linkCount[thisGroupStats->linkCount.size()-1] += 1;
-					else //different groups
-					{
-						if (!getTest(ggmp1, g1, p1s, ggmp2, g2, p2s))
-							thisGroupStats->linkCount[thisGroupStats->linkCount.size()-1] += 1;				
-					}
-				}		
-		}
-	} //end for each link in random network
+	for (int j = 0; j < (int)groups2.size(); j++)
+		if (groups2[j].groupId < geneGroupMap1.groupIndex.size())
+			same[j] = geneGroupMap1.groupIndex[groups2[j].groupId];
+	
+	if (geneGroupMap1.narrow && geneGroupMap2.narrow)
+		countLinks12<uint16_t, uint16_t>(net, links, groupStats, geneGroupMap1, geneGroupMap2, same);
+	else if (geneGroupMap1.narrow)
+		countLinks12<uint16_t, uint32_t>(net, links, groupStats, geneGroupMap1, geneGroupMap2, same);
+	else if (geneGroupMap2.narrow)
+		countLinks12<uint32_t, uint16_t>(net, links, groupStats, geneGroupMap1, geneGroupMap2, same);
+	else
+		countLinks12<uint32_t, uint32_t>(net, links, groupStats, geneGroupMap1, geneGroupMap2, same);
 	
 	cout << "done in " << (clock()-start)/(CLOCKS_PER_SEC+0.0) <<" seconds." << endl;
 }
 
+void countLinksForGroups12(const CSRGraph &net,
+								const LinkList &links,
+								vector<GeneGroup> &groups1,
+								vector<GeneGroup> &groups2,
+								vector<Stats> &groupStats,
+								GeneGroupMap &geneGroupMap1,
+								GeneGroupMap &geneGroupMap2) 
+{
+	countLinksForGroups12(net, &links, groups1, groups2, groupStats, geneGroupMap1, geneGroupMap2);
+}
+
+void countLinksForGroups12(const CSRGraph &net,
+								vector<GeneGroup> &groups1,
+								vector<GeneGroup> &groups2,
+								vector<Stats> &groupStats,
+								GeneGroupMap &geneGroupMap1,
+								GeneGroupMap &geneGroupMap2) 
+{
+	countLinksForGroups12(net, NULL, groups1, groups2, groupStats, geneGroupMap1, geneGroupMap2);
+}
+
 template <class T>
 void calcStatFromVec(vector<T> &vec, int s, float &mean, float &std)
 {
@@ -1099,21 +1212,23 @@ void calcStatFromVec(vector<T> &vec, int s, float &mean, float &std)
 }
 
 
-void calculateAndWriteResultsAll(Graph &origNet,
+void calculateAndWriteResultsAll(const CSRGraph &origNet,
 								 vector<GeneGroup> &groups,
-								 map<string, Stats > &groupStats,
-								 map<string, vector<string> > &geneGroupMap,
+								 vector<Stats> &groupStats,
+								 GeneGroupMap &geneGroupMap,
 								 string path) 
 {
 	ofstream file;
 	float NobservedLinks, NexpectedLinks, stdDev;// CCobserved, CCexpected, , stdDevCC;
-	string groupsVsStr, g1, g2;
+	string groupsVsStr;
+	int pairIndex, pairCount = pairCountAll(groups.size());
 	Stats *thisGroupStats;
-	vector<pair<string, double> > sortedPValuesIntra;
-	vector<pair<string, double> > sortedPValuesInter;
+	vector<pair<int, double> > sortedPValuesIntra;
+	vector<pair<int, double> > sortedPValuesInter;
+	vector<double> fdrs(pairCount, 0.0);
 	vector<int> *gsm;
-	map<string, int > kSuccess, nDraws, mSuccesses;
-	map<string, Stats > observedGroupStats;
+	vector<int> kSuccess(pairCount, 0), nDraws(pairCount, 0), mSuccesses(pairCount, 0);
+	vector<Stats> observedGroupStats;
 	int gss = 0, N = 0; 
 	
 	cout << "Calculating results... " << endl;
@@ -1124,22 +1239,15 @@ void calculateAndWriteResultsAll(Graph &origNet,
 	{
 		for (int j = 0; j <= i; j++)
 		{
-			g1 = groups[i].groupId;
-			g2 = groups[j].groupId;
-			
-			if (g1 >= g2)
-				groupsVsStr = g1 + "_vs_" + g2;
-			else
-				groupsVsStr = g2 + "_vs_" + g1;
-			
-			thisGroupStats = &(groupStats[groupsVsStr]);
+			pairIndex = pairIndexAll(i, j);
+			thisGroupStats = &(groupStats[pairIndex]);
 					
 			gsm = &(thisGroupStats->linkCount);
 			gss = (int)gsm->size();
 									
 			calcStatFromVec((*gsm), gss, NexpectedLinks, stdDev);
 			
-			NobservedLinks = observedGroupStats[groupsVsStr].linkCount[0];
+			NobservedLinks = observedGroupStats[pairIndex].linkCount[0];
 				
 			thisGroupStats->expectedLinks = NexpectedLinks;
 			thisGroupStats->observedLinks = NobservedLinks;
@@ -1154,9 +1262,9 @@ void calculateAndWriteResultsAll(Graph &origNet,
 				thisGroupStats->chiSqr = calculateReducedChiSquare((*gsm), NexpectedLinks, stdDev);
 
 				if (i == j)
-				  sortedPValuesIntra.push_back(pair<string, long double>(groupsVsStr, thisGroupStats->pValue));
+				  sortedPValuesIntra.push_back(pair<int, double>(pairIndex, thisGroupStats->pValue));
 				else
-				  sortedPValuesInter.push_back(pair<string, long double>(groupsVsStr, thisGroupStats->pValue)); 
+				  sortedPValuesInter.push_back(pair<int, double>(pairIndex, thisGroupStats->pValue)); 
 			}
 			
 			/*
@@ -1200,6 +1308,7 @@ void calculateAndWriteResultsAll(Graph &origNet,
 		if (sortedPValuesIntra[c].second > 1.0)
 			sortedPValuesIntra[c].second = 1.0;
 		//cout << "Adjusting intra "<< old << " by " << sortedPValuesIntra.size()/(c+1.0) << " to " << sortedPValuesIntra[c].second << endl;
+		fdrs[sortedPValuesIntra[c].first] = sortedPValuesIntra[c].second;
 	}	 
 	for (int c = 0; c < (int)sortedPValuesInter.size(); c++)
 	{
@@ -1208,26 +1317,23 @@ void calculateAndWriteResultsAll(Graph &origNet,
 		if (sortedPValuesInter[c].second > 1.0)
 			sortedPValuesInter[c].second = 1.0;
 		//cout << "Adjusting inter "<< old << " to " << sortedPValuesInter[c].second << endl;
+		fdrs[sortedPValuesInter[c].first] = sortedPValuesInter[c].second;
 	}
 	
 	if (doHyper){
 		N = getTotalInputUniqueGeneCount(groups[0].inputFilePath, groups[0].inputFilePath);
 		
 		cout << "P-hyper using N (total unique genes in the two grops) = " << N << endl;
+		
+		countSharedGenes(groups, groups, true, kSuccess);
 	
 		for (int i = 0; i < (int)groups.size(); i++)
 		{
 			for (int j = 0; j <= i; j++)
 			{
-				groupsVsStr = groups[i].groupId + "_vs_" + groups[j].groupId;
-				int countShared = 0;
-				for (int k = 0; k < (int)groups[i].groupGenes.size(); k++)
-					for (int l = 0; l < (int)groups[j].groupGenes.size(); l++)
-						if (groups[i].groupGenes[k] == groups[j].groupGenes[l])
-							countShared++;
-				kSuccess[groupsVsStr] = countShared;
-				nDraws[groupsVsStr] = MIN(groups[i].groupGenes.size(), groups[j].groupGenes.size());
-				mSuccesses[groupsVsStr] = MAX(groups[i].groupGenes.size(), groups[j].groupGenes.size());
+				pairIndex = pairIndexAll(i, j);
+				nDraws[pairIndex] = MIN(groups[i].groupGenes.size(), groups[j].groupGenes.size());
+				mSuccesses[pairIndex] = MAX(groups[i].groupGenes.size(), groups[j].groupGenes.size());
 			}
 		}
 	}
@@ -1246,18 +1352,12 @@ void calculateAndWriteResultsAll(Graph &origNet,
 	file << "PAIR\ttype1 type2\tintra/inter\tObserved links\tExpected Links\tZscore\tp-value\tpFDR\tstdDev\tReduced ChiSqr"<<endl;
 	for (int i = 0; i < (int)groups.size(); i++)
 	{
-		groupsVsStr = groups[i].groupId + "_vs_" + groups[i].groupId;
-		thisGroupStats = &(groupStats[groupsVsStr]);
+		pairIndex = pairIndexAll(i, i);
+		groupsVsStr = groupsVsString(groups[i], groups[i]);
+		thisGroupStats = &(groupStats[pairIndex]);
 		
 		bool testValid = (thisGroupStats->stdDev != 0.0);
-		long double fdr = 0;
-		
-		for (int c = 0; c < (int)sortedPValuesIntra.size() ; c++)
-			if (groupsVsStr == sortedPValuesIntra[c].first)
-			{
-				fdr = sortedPValuesIntra[c].second;
-				break;
-			}	 
+		long double fdr = fdrs[pairIndex];
 
 		file.precision(6);
 		file	<< groupsVsStr << "\t" 
@@ -1270,7 +1370,7 @@ void calculateAndWriteResultsAll(Graph &origNet,
 			<< ((testValid)?lexical_cast<string>(fdr):"NA") << "\t"
 			<< ((testValid)?lexical_cast<string>(thisGroupStats->stdDev):"NA") << "\t"
 			<< thisGroupStats->chiSqr << "\t"
-			<< ((testValid)?(doHyper?lexical_cast<string>(pHyper(nDraws[groupsVsStr], mSuccesses[groupsVsStr], kSuccess[groupsVsStr], N)):""):"NA")<< "\t"	
+			<< ((testValid)?(doHyper?lexical_cast<string>(pHyper(nDraws[pairIndex], mSuccesses[pairIndex], kSuccess[pairIndex], N)):""):"NA")<< "\t"	
 			<< endl;
 					
 	}
@@ -1286,18 +1386,12 @@ void calculateAndWriteResultsAll(Graph &origNet,
 		{
 			if (i==j)continue;
 			
-			groupsVsStr = groups[i].groupId + "_vs_" + groups[j].groupId;
-			thisGroupStats = &(groupStats[groupsVsStr]);
+			pairIndex = pairIndexAll(i, j);
+			groupsVsStr = groupsVsString(groups[i], groups[j]);
+			thisGroupStats = &(groupStats[pairIndex]);
 		
 			bool testValid = (thisGroupStats->stdDev != 0.0);
-			long double fdr = 0;
-			
-			for (int c = 0; c < (int)sortedPValuesInter.size() ; c++)
-				if (groupsVsStr == sortedPValuesInter[c].first)
-				{
-					fdr = sortedPValuesInter[c].second;
-					break;
-				}	 
+			long double fdr = fdrs[pairIndex];
 			
 			file.precision(6);
 			file	<< groupsVsStr << "\t" 
@@ -1310,7 +1404,7 @@ void calculateAndWriteResultsAll(Graph &origNet,
 				<< ((testValid)?lexical_cast<string>(fdr):"NA") << "\t"	
 				<< ((testValid)?lexical_cast<string>(thisGroupStats->stdDev):"NA") << "\t"
 				<< thisGroupStats->chiSqr << "\t"
-				<< ((testValid)?(doHyper?lexical_cast<string>(pHyper(nDraws[groupsVsStr], mSuccesses[groupsVsStr], kSuccess[groupsVsStr], N)):""):"NA")<< "\t"
+				<< ((testValid)?(doHyper?lexical_cast<string>(pHyper(nDraws[pairIndex], mSuccesses[pairIndex], kSuccess[pairIndex], N)):""):"NA")<< "\t"
 				<< endl;
 		}
 	}
@@ -1322,12 +1416,9 @@ void calculateAndWriteResultsAll(Graph &origNet,
 	for (int i = 0; i < (int)groups.size(); i++)
 		for (int j = 0; j <= i; j++)
 		{
-			groupsVsStr = groups[i].groupId;
-			groupsVsStr += "_vs_";
-			groupsVsStr += groups[j].groupId;
-			file << groupsVsStr<<"\t";
-			for (int c = 0; c < (int)groupStats[groupsVsStr].linkCount.size(); c++)
-				file << groupStats[groupsVsStr].linkCount[c] << "\t";
+			file << groupsVsString(groups[i], groups[j])<<"\t";
+			for (int c = 0; c < (int)groupStats[pairIndexAll(i, j)].linkCount.size(); c++)
+				file << groupStats[pairIndexAll(i, j)].linkCount[c] << "\t";
 			file << endl;
 		}
 	file.close();
@@ -1336,22 +1427,25 @@ void calculateAndWriteResultsAll(Graph &origNet,
 	
 }
 
-void calculateAndWriteResults12(Graph &origNet,
+void calculateAndWriteResults12(const CSRGraph &origNet,
 								 vector<GeneGroup> &groups1,
 								 vector<GeneGroup> &groups2,
-								 map<string, Stats > &groupStats,
-								 map<string, vector<string> > &geneGroupMap1,
-								 map<string, vector<string> > &geneGroupMap2,
+								 vector<Stats> &groupStats,
+								 GeneGroupMap &geneGroupMap1,
+								 GeneGroupMap &geneGroupMap2,
 								 string path) 
 {
 	ofstream file;
 	float NobservedLinks, NexpectedLinks, stdDev;
-	string groupsVsStr, g1, g2, p1, p2;
+	string groupsVsStr;
+	SymbolTable::Symbol g1, g2;
+	int pairIndex, pairCount = groups1.size()*groups2.size();
 	Stats *thisGroupStats;
-	vector<pair<string, long double> > sortedPValues;
+	vector<pair<int, long double> > sortedPValues;
+	vector<long double> fdrs(pairCount, 0.0);
  	vector<int> *gsm;
-	map<string, int > kSuccess, nDraws, mSuccesses;
-	map<string, Stats > observedGroupStats;
+	vector<int> kSuccess(pairCount, 0), nDraws(pairCount, 0), mSuccesses(pairCount, 0);
+	vector<Stats> observedGroupStats;
 	int gss = 0, N = 0; 
 						
 	cout << "Calculating results... " << endl;
@@ -1365,8 +1459,8 @@ void calculateAndWriteResults12(Graph &origNet,
 			g1 = groups1[i].groupId;
 			g2 = groups2[j].groupId;
 			
-			groupsVsStr = g1 + "_vs_" + g2;
-			thisGroupStats = &(groupStats[groupsVsStr]);
+			pairIndex = pairIndex12(i, j, groups2.size());
+			thisGroupStats = &(groupStats[pairIndex]);
 		
 			gsm = &(thisGroupStats->linkCount);
 			gss = (int)gsm->size();
@@ -1376,7 +1470,7 @@ void calculateAndWriteResults12(Graph &origNet,
 			
 			calcStatFromVec((*gsm), gss, NexpectedLinks, stdDev);
 			
-			NobservedLinks = observedGroupStats[groupsVsStr].linkCount[0]*((g1==g2)?0.5:1.0);
+			NobservedLinks = observedGroupStats[pairIndex].linkCount[0]*((g1==g2)?0.5:1.0);
 						
 			thisGroupStats->observedLinks = NobservedLinks; 
 			thisGroupStats->expectedLinks = NexpectedLinks;
@@ -1394,7 +1488,7 @@ void calculateAndWriteResults12(Graph &origNet,
 			    for (c = 0; c < (int)sortedPValues.size(); c++)
 			  	  if (sortedPValues[c].second > thisGroupStats->pValue)
 			  		  break;
-				sortedPValues.insert(sortedPValues.begin()+c, pair<string, float>(groupsVsStr, thisGroupStats->pValue));
+				sortedPValues.insert(sortedPValues.begin()+c, pair<int, float>(pairIndex, thisGroupStats->pValue));
 			}			
 		}
 	}
@@ -1405,25 +1499,23 @@ void calculateAndWriteResults12(Graph &origNet,
 		if (sortedPValues[c].second > 1.0)
 			sortedPValues[c].second = 1.0;
 	}
+	for (int c = 0; c < (int)sortedPValues.size(); c++)
+		fdrs[sortedPValues[c].first] = sortedPValues[c].second;
 
 	if (doHyper){
 		N = getTotalInputUniqueGeneCount(groups1[0].inputFilePath, groups2[0].inputFilePath);
 		
 		cout << "P-hyper using N (total unique genes in the two grops) = " << N << endl;
+		
+		countSharedGenes(groups1, groups2, false, kSuccess);
 	
 		for (int i = 0; i < (int)groups1.size(); i++)
 		{
 			for (int j = 0; j < (int)groups2.size(); j++)
 			{
-				groupsVsStr = groups1[i].groupId + "_vs_" + groups2[j].groupId;
-				int countShared = 0;
-				for (int k = 0; k < (int)groups1[i].groupGenes.size(); k++)
-					for (int l = 0; l < (int)groups2[j].groupGenes.size(); l++)
-						if (groups1[i].groupGenes[k] == groups2[j].groupGenes[l])
-							countShared++;
-				kSuccess[groupsVsStr] = countShared;
-				nDraws[groupsVsStr] = MIN(groups1[i].groupGenes.size(), groups2[j].groupGenes.size());
-				mSuccesses[groupsVsStr] = MAX(groups1[i].groupGenes.size(), groups2[j].groupGenes.size());
+				pairIndex = pairIndex12(i, j, groups2.size());
+				nDraws[pairIndex] = MIN(groups1[i].groupGenes.size(), groups2[j].groupGenes.size());
+				mSuccesses[pairIndex] = MAX(groups1[i].groupGenes.size(), groups2[j].groupGenes.size());
 			}
 		}
 	}
@@ -1442,22 +1534,16 @@ void calculateAndWriteResults12(Graph &origNet,
 	{
 		for (int j = 0; j < (int)groups2.size(); j++)
 		{	
-			groupsVsStr = groups1[i].groupId + "_vs_" + groups2[j].groupId;
-			thisGroupStats = &(groupStats[groupsVsStr]);
+			pairIndex = pairIndex12(i, j, groups2.size());
+			groupsVsStr = groupsVsString(groups1[i], groups2[j]);
+			thisGroupStats = &(groupStats[pairIndex]);
 		
 			bool testValid = (thisGroupStats->stdDev != 0.0);
 
-			long double fdr = 0;
+			long double fdr = fdrs[pairIndex];
 			
 			if (testValid)
 			{
-				for (int c = 0; c < (int)sortedPValues.size() ; c++)
-					if (groupsVsStr == sortedPValues[c].first)
-					{
-						fdr = sortedPValues[c].second;
-						break;
-					}	 
-				
 				file.precision(6);
 				file	<< groupsVsStr << "\t" 
 					<< groups1[i].groupSys <<" "<< groups2[j].groupSys << "\t" 
@@ -1469,7 +1555,7 @@ void calculateAndWriteResults12(Graph &origNet,
 					<< fdr << "\t"
 					<< thisGroupStats->stdDev << "\t"
 					<< thisGroupStats->chiSqr << "\t"
-					<< ((doHyper)?lexical_cast<string>(pHyper(nDraws[groupsVsStr], mSuccesses[groupsVsStr], kSuccess[groupsVsStr], N)):"")<< "\t"
+					<< ((doHyper)?lexical_cast<string>(pHyper(nDraws[pairIndex], mSuccesses[pairIndex], kSuccess[pairIndex], N)):"")<< "\t"
 					<< endl;
 	
 			}
@@ -1495,15 +1581,12 @@ void calculateAndWriteResults12(Graph &origNet,
 	
 /*#if DEBUG
 	file.open("groupStats.out");
-	for (int i = 0; i < (int)groups.size(); i++)
-		for (int j = 0; j <= i; j++)
+	for (int i = 0; i < (int)groups1.size(); i++)
+		for (int j = 0; j < (int)groups2.size(); j++)
 		{
-			groupsVsStr = groups[i].groupId;
-			groupsVsStr += "_vs_";
-			groupsVsStr += groups[j].groupId;
-			file << groupsVsStr<<"\t";
-			for (int c = 0; c < (int)groupStats[groupsVsStr].linkCount.size(); c++)
-				file << groupStats[groupsVsStr].linkCount[c] << "\t";
+			file << groupsVsString(groups1[i], groups2[j])<<"\t";
+			for (int c = 0; c < (int)groupStats[pairIndex12(i, j, groups2.size())].linkCount.size(); c++)
+				file << groupStats[pairIndex12(i, j, groups2.size())].linkCount[c] << "\t";
 			file << endl;
 		}
 	file.close();
@@ -1513,76 +1596,56 @@ void calculateAndWriteResults12(Graph &origNet,
 }
 
 
-void generateMaps(Graph &origNet,
-				  Graph &randNet,
+void generateMaps(const CSRGraph &origNet,
 				  map<int, vector<Record> > &degRecordsMap)
 {
 	cout << "Generating maps...";flush(cout);
-		
-	Graph::Node v1;
-	map<string, Graph::Node> g2vMap;
-	string gene;
 	
-	geneVertMap.clear();
+	geneNodeIds.assign(geneSymbols.size(), CSRGraph::NONE);
 	degRecordsMap.clear();
 	
-	for (Graph::node_range_t vr = randNet.getNodes(); vr.first != vr.second; vr.first++)
+	for (CSRGraph::NodeId id = 0; id < (CSRGraph::NodeId)origNet.getNodeCount(); id++)
 	{
-		v1 = *vr.first;
-		g2vMap[randNet.properties(v1).geneId] = v1;
+		geneNodeIds[origNet.getGeneId(id)] = id;
 		
 		Record record;
-		record.node = v1;
-		record.degree = randNet.getNodeDegree(record.node); //at this point randNet is exact copy of origNet
+		record.node = id;
+		record.degree = origNet.getNodeDegree(id);
 		//record.smetric = calculateSmetricNode(randNet, record.);
-		degRecordsMap[DEGREE_BIN(record.degree)].push_back(record);
-	}
-	for (Graph::node_range_t vr = origNet.getNodes(); vr.first != vr.second; vr.first++)
-	{
-		v1 = *vr.first;
-		gene = origNet.properties(v1).geneId;
-		geneVertMap[gene].push_back(v1);
-		geneVertMap[gene].push_back(g2vMap[gene]);		
+		degRecordsMap[origNet.getNodeBin(id)].push_back(record);
 	}
 	
-	for (Graph::node_range_t vr = randNet.getNodes(); vr.first != vr.second; vr.first++)
-	{
-		v1 = *vr.first;
-		for (Graph::adjacency_node_range_t avr = randNet.getAdjacentNodes(v1); avr.first != avr.second; avr.first++)
-			origNet.properties(geneVertMap[randNet.properties(v1).geneId][0]).connectedDegrees.push_back(DEGREE_BIN(randNet.getNodeDegree(*avr.first)));
-	}
-	
-	for (Graph::node_range_t vr = origNet.getNodes(); vr.first != vr.second; vr.first++)
-		randNet.properties(geneVertMap[origNet.properties(*vr.first).geneId][1]).connectedDegrees = origNet.properties(*vr.first).connectedDegrees;	
-	
-	g2vMap.clear();
 	cout << "done." << endl;
 }
 
 
-Graph::Node getNodeById(const Graph &g, const string &Id)
+CSRGraph::NodeId getNodeById(SymbolTable::Symbol gene)
 {
-	if (!keyInMap(Id, geneVertMap))
-		return NULL;
-	return (geneVertMap[Id][g.id]);
+	if (gene >= geneNodeIds.size())
+		return CSRGraph::NONE;
+	return geneNodeIds[gene];
 }
 
-void copyOrigToRand(Graph &origNet, Graph &randNet)
+void copyOrigToRand(const CSRGraph &origNet, RandomGraph &randNet)
 {
-	Graph::Node v1, v2;
-	LinkProperties link;
-	link.weight = 1.0;
+	randNet.copyLinks(origNet);
+}
 
-	//cout << "num links before: " << randNet.getLinkCount() << endl;
-	randNet.RemoveAllLinks();
-	//cout << "num links after: " << randNet.getLinkCount() << endl;
-	
-	for (Graph::link_range_t er = origNet.getLinks(); er.first != er.second; er.first++)
-	{
-		origNet.getNodesByLink(*er.first, v1, v2);
-		link.weight = origNet.properties(*er.first).weight;
-		randNet.AddLink(geneVertMap[origNet.properties(v1).geneId][1], geneVertMap[origNet.properties(v2).geneId][1], link); 	
-	}
+void getRandomLinkWeights(const CSRGraph &origNet, const RandomGraph &randNet, vector<float> &weights)
+{
+	const vector<RandomGraph::NodeId> &labels = randNet.getLabels();
+	const LinkList &links = randNet.getLinks();
+	vector<RandomGraph::NodeId> carrier(labels.size());
+	
+	weights.clear();
+	if (!origNet.hasWeights())
+		return;
+	//carrier[u]: the node whose label node u carries
+	for (RandomGraph::NodeId v = 0; v < (RandomGraph::NodeId)labels.size(); v++)
+		carrier[labels[v]] = v;
+	weights.resize(links.size());
+	for (int k = 0; k < (int)links.size(); k++)
+		weights[k] = origNet.getLinkWeight(carrier[links[k].first], carrier[links[k].second], 1);
 }
 
 
@@ -1592,18 +1655,32 @@ void printNetwork(const Graph &network)
 	for (Graph::node_range_t vr = network.getNodes(); vr.first != vr.second; vr.first++)
 	{
 		Graph::Node v1 = *vr.first;
-		cout << network.properties(v1).geneId << " " << network.getNodeDegree(v1) << endl;
+		cout << geneSymbols.getName(network.properties(v1).geneId) << " " << network.getNodeDegree(v1) << endl;
 		
 		for (Graph::adjacency_node_range_t avr = network.getAdjacentNodes(v1); avr.first != avr.second; avr.first++)
 		{	
 			Graph::Node v2 = *avr.first;
 			Graph::LinkPair linkPair;
 			if (network.getLinkPair(v1, v2, linkPair) == LINK_BOTH)
-				cout << "\t" << network.properties(v2).geneId <<"\t"<< network.properties(linkPair.first).weight << "\t"<< network.properties(linkPair.second).weight << endl;
+				cout << "\t" << geneSymbols.getName(network.properties(v2).geneId) << endl;
 		}
    }
 }
 
+string getOrderString(int o)
+{
+	switch (o)
+	{
+		case ORDER_FILE:
+			return string("File order");
+		case ORDER_DEGREE:
+			return string("Decreasing degree");
+		case ORDER_RCM:
+			return string("Reverse Cuthill-McKee");
+	}
+	return string("");
+}
+
 string getMethodString(int m)
 {
 	switch (m)
@@ -1622,89 +1699,65 @@ string getMethodString(int m)
 
 int getTotalInputUniqueGeneCount(string path1, string path2)
 {
-	string line;
-	vector<string> lineVals; 
-	map<string, int > uniqueGenesInPool;
-	ifstream file;
+	GroupCollection collection;
+	vector<char> inPool; //flags by gene symbol
 	int ret = 0;
 	
-	file.open(path1.c_str());
-	if (!file)
-	{
-		cout << "Error in opening "<< path1 << endl;
-		exit(1);
-	}
-	
-	while(getline(file, line))
-	{
-		split(lineVals, line, is_any_of(", \t"));
-		for (int c = 0; c < (int)lineVals.size(); c++) //clean out peoples trash.
-			if (lineVals[c] == ""){
-				lineVals.erase(lineVals.begin()+c);
-				c = 0;
-			}
-		if (lineVals.size() < 2)
-			continue;
+	//the files were read by readGeneGroups, so this normally reads their caches
+	collection.load(path1, useGroupCache);
+	if (path2 == path1)
+		return collection.genes.size();
 		
-		to_upper(lineVals[GROUP_GENE]);
-		if (!keyInMap(lineVals[GROUP_GENE], uniqueGenesInPool)){
-			uniqueGenesInPool[lineVals[GROUP_GENE]] = 1;
-			ret++;
-		}
-	}
-	file.close();
-	
-	file.open(path2.c_str());
-	if (!file)
+	inPool.assign(geneSymbols.size(), 0);
+	for (int k = 0; k < (int)collection.genes.size(); k++)
 	{
-		cout << "Error in opening "<< path2 << endl;
-		exit(1);
+		inPool[collection.genes[k]] = 1;
+		ret++;
 	}
 	
-	while(getline(file, line))
-	{
-		split(lineVals, line, is_any_of(", \t"));
-		for (int c = 0; c < (int)lineVals.size(); c++) //clean out peoples trash.
-			if (lineVals[c] == ""){
-				lineVals.erase(lineVals.begin()+c);
-				c = 0;
-			}
-		if (lineVals.size() < 2)
-			continue;
-		
-		to_upper(lineVals[GROUP_GENE]);
-		if (!keyInMap(lineVals[GROUP_GENE], uniqueGenesInPool)){
-			uniqueGenesInPool[lineVals[GROUP_GENE]] = 1;
+	collection.load(path2, useGroupCache);
+	inPool.resize(geneSymbols.size(), 0);
+	for (int k = 0; k < (int)collection.genes.size(); k++)
+		if (!inPool[collection.genes[k]]){
+			inPool[collection.genes[k]] = 1;
 			ret++;
 		}
-	}
-	file.close();
 
 	return ret;
 }
 
-long long calculateSmetricNetwork(const Graph &g)
+long long calculateSmetricNetwork(const RandomGraph &g)
 {
 	long long s_metric = 0;
-	Graph::Node v1, v2;
-	for (Graph::link_range_t er = g.getLinks(); er.first != er.second; er.first++)
+	RandomGraph::NodeId v1, v2;
+	for (int k = 0; k < g.getLinkCount(); k++)
 	{
-		g.getNodesByLink(*er.first, v1, v2);
+		g.getNodesByLink(k, v1, v2);
 		s_metric += g.getNodeDegree(v1)*g.getNodeDegree(v2);
 	}
 	return s_metric;	
 }
 
-float calculateRfromNetwork(const Graph &g)
+long long calculateSmetricNetwork(const CSRGraph &g)
+{
+	long long s_metric = 0;
+	CSRGraph::adjacency_node_range_t avr;
+	for (CSRGraph::NodeId v1 = 0; v1 < (CSRGraph::NodeId)g.getNodeCount(); v1++)
+		for (avr = g.getLinkNeighbors(v1); avr.first != avr.second; avr.first++)
+			s_metric += g.getNodeDegree(v1)*g.getNodeDegree(*avr.first);
+	return s_metric;	
+}
+
+float calculateRfromNetwork(const RandomGraph &g)
 {
 	long double invLinkCount = 1.0/g.getLinkCount();
 	long double term1=0, term2=0, term3=0;
 	long double r = 0;
-	Graph::Node v1, v2;
+	RandomGraph::NodeId v1, v2;
 	int d1, d2;
-	for (Graph::link_range_t er = g.getLinks(); er.first != er.second; er.first++)
+	for (int k = 0; k < g.getLinkCount(); k++)
 	{
-		g.getNodesByLink(*er.first, v1, v2);
+		g.getNodesByLink(k, v1, v2);
 		d1 = g.getNodeDegree(v1);
 		d2 = g.getNodeDegree(v2);
 		term1 += d1*d2;
@@ -1716,6 +1769,27 @@ float calculateRfromNetwork(const Graph &g)
 	return r; 	
 }
 
+float calculateRfromNetwork(const CSRGraph &g)
+{
+	long double invLinkCount = 1.0/g.getLinkCount();
+	long double term1=0, term2=0, term3=0;
+	long double r = 0;
+	CSRGraph::adjacency_node_range_t avr;
+	int d1, d2;
+	for (CSRGraph::NodeId v1 = 0; v1 < (CSRGraph::NodeId)g.getNodeCount(); v1++)
+		for (avr = g.getLinkNeighbors(v1); avr.first != avr.second; avr.first++)
+		{
+			d1 = g.getNodeDegree(v1);
+			d2 = g.getNodeDegree(*avr.first);
+			term1 += d1*d2;
+			term2 += 0.5*(d1+d2);
+			term3 += 0.5*(d1*d1+d2*d2);
+		}
+	r = invLinkCount*term1 - powl(invLinkCount*term2, 2.0);
+	r /= (invLinkCount*term3 - powl(invLinkCount*term2, 2.0));
+	return r; 	
+}
+
 int calculateSmetricNode(const Graph &g, Graph::Node v)
 {
 	int sum = 0;
@@ -1777,7 +1851,7 @@ float calculateReducedChiSquare(vector<T> &dataSet, const float mean, const floa
 	return chiSqr/(N-3);
 }
 
-float calculateClusteringCoeffForTwoGroups(const Graph &graph, const GeneGroup &group1, const GeneGroup &group2)
+float calculateClusteringCoeffForTwoGroups(const CSRGraph &graph, const GeneGroup &group1, const GeneGroup &group2)
 {
 	
 	if (group1.groupId == group2.groupId)
@@ -1804,23 +1878,23 @@ float calculateClusteringCoeffForTwoGroups(const Graph &graph, const GeneGroup &
 	}
 }
 
-float calculateClusteringCoeffForGroup(const Graph &graph, const GeneGroup &group)
+float calculateClusteringCoeffForGroup(const CSRGraph &graph, const GeneGroup &group)
 {
-	Graph::Node v1;
+	CSRGraph::NodeId v1;
 	float numLinksInSubGraph, v1Deg, ret;
 	
 	ret = 0;
 	for (int i = 0; i < (int)group.groupGenes.size(); i++)
 	{
-		v1 = getNodeById(graph, group.groupGenes[i]);
+		v1 = getNodeById(group.groupGenes[i]);
 		v1Deg = graph.getNodeDegree(v1);
 		numLinksInSubGraph = 0;
 		
 		if (v1Deg <= 1)
 			continue;
 		
-		for (Graph::adjacency_node_range_t avr1 = graph.getAdjacentNodes(v1); avr1.first != avr1.second; avr1.first++)
-			for (Graph::adjacency_node_range_t avr2 = graph.getAdjacentNodes(v1); avr2.first != avr2.second; avr2.first++)
+		for (CSRGraph::adjacency_node_range_t avr1 = graph.getAdjacentNodes(v1); avr1.first != avr1.second; avr1.first++)
+			for (CSRGraph::adjacency_node_range_t avr2 = graph.getAdjacentNodes(v1); avr2.first != avr2.second; avr2.first++)
 			{
 				if (avr1.first == avr2.first)
 					continue;
@@ -1841,17 +1915,17 @@ float calculateClusteringCoeffForGroup(const Graph &graph, const GeneGroup &grou
 }
 
 
-float calculateClusteringCoeffForGroupOnly(const Graph &graph, const GeneGroup &group)
+float calculateClusteringCoeffForGroupOnly(const CSRGraph &graph, const GeneGroup &group)
 {
-	Graph::Node v1;
+	CSRGraph::NodeId v1;
 	float numLinksInSubGraph, v1Deg, ret;
 	ret = 0;
-	map<Graph::Node, bool> adjGenesInGroup;
-	map<Graph::Node, bool>::iterator it;
+	map<CSRGraph::NodeId, bool> adjGenesInGroup;
+	map<CSRGraph::NodeId, bool>::iterator it;
 	
 	for (int i = 0; i < (int)group.groupGenes.size(); i++)
 	{
-		v1 = getNodeById(graph, group.groupGenes[i]);
+		v1 = getNodeById(group.groupGenes[i]);
 		v1Deg = graph.getNodeDegree(v1);
 		numLinksInSubGraph = 0;
 		
@@ -1859,17 +1933,17 @@ float calculateClusteringCoeffForGroupOnly(const Graph &graph, const GeneGroup &
 			continue;
 		
 		adjGenesInGroup.clear();
-		for (Graph::adjacency_node_range_t avr1 = graph.getAdjacentNodes(v1); avr1.first != avr1.second; avr1.first++)
+		for (CSRGraph::adjacency_node_range_t avr1 = graph.getAdjacentNodes(v1); avr1.first != avr1.second; avr1.first++)
 		{
 			for (int j = 0; j < (int)group.groupGenes.size(); j++)
-				if (graph.properties(*avr1.first).geneId == group.groupGenes[j])
+				if (graph.getGeneId(*avr1.first) == group.groupGenes[j])
 				{
 					adjGenesInGroup[*avr1.first] = true;
 					break;
 				}
 		}
 		
-		for (Graph::adjacency_node_range_t avr1 = graph.getAdjacentNodes(v1); avr1.first != avr1.second; avr1.first++)
+		for (CSRGraph::adjacency_node_range_t avr1 = graph.getAdjacentNodes(v1); avr1.first != avr1.second; avr1.first++)
 			for (it = adjGenesInGroup.begin(); it != adjGenesInGroup.end(); it++)
 				if (graph.hasLink(*avr1.first, (*it).first))
 					numLinksInSubGraph += 1.0;	
@@ -1887,10 +1961,9 @@ float calculateClusteringCoeffForGroupOnly(const Graph &graph, const GeneGroup &
 
 
 #if SPLIT_GROUPS
-void splitGroups(vector<GeneGroup> &groups, map<string, vector<string> > &geneGroupMap)
+void splitGroups(const CSRGraph &origNet, vector<GeneGroup> &groups, GeneGroupMap &geneGroupMap)
 {
 	cout << "\n***Warning*** splitting groups!\n";
-	geneGroupMap.clear();
 	
 	vector<GeneGroup> groupsNew;
 	GeneGroup group1, group2;
@@ -1901,11 +1974,8 @@ void splitGroups(vector<GeneGroup> &groups, map<string, vector<string> > &geneGr
 		
 		random_shuffle(groups[i].groupGenes.begin(), groups[i].groupGenes.end());
 		
-		group1.groupId = groups[i].groupId;
-		group2.groupId = groups[i].groupId;
-		
-		group1.groupId += "_1";
-		group2.groupId += "_2";
+		group1.groupId = groupSymbols.intern(groupSymbols.getName(groups[i].groupId) + "_1");
+		group2.groupId = groupSymbols.intern(groupSymbols.getName(groups[i].groupId) + "_2");
 		
 		group1.groupSpe = groups[i].groupSpe;
 		group2.groupSpe = groups[i].groupSpe;
@@ -1919,13 +1989,11 @@ void splitGroups(vector<GeneGroup> &groups, map<string, vector<string> > &geneGr
 		//printf("\n");
 		for(int j = 0; j < (int)(groups[i].groupGenes.size()/2); j++)
 		{
-			geneGroupMap[groups[i].groupGenes[j]].push_back(group1.groupId);
 			group1.groupGenes.push_back(groups[i].groupGenes[j]);
 		//	printf("%s\t%s\n", group1.groupId.c_str(), groups[i].groupGenes[j].c_str());
 		}
 		for(int j = (int)(groups[i].groupGenes.size()/2); j < (int)groups[i].groupGenes.size(); j++)
 		{
-			geneGroupMap[groups[i].groupGenes[j]].push_back(group2.groupId);
 			group2.groupGenes.push_back(groups[i].groupGenes[j]);
 		//	printf("%s\t%s\n", group2.groupId.c_str(), groups[i].groupGenes[j].c_str());
 		}
@@ -1937,9 +2005,8 @@ void splitGroups(vector<GeneGroup> &groups, map<string, vector<string> > &geneGr
 		groupsNew.push_back(group2);
 	}
 
-	groups.clear();
-	for (int i = 0; i < (int)groupsNew.size(); i++)
-		groups.push_back(groupsNew[i]);
+	groups.swap(groupsNew);
+	buildGeneGroupMap(origNet, groups, geneGroupMap);
 
 }
 
@@ -1980,7 +2047,7 @@ double randn_trig(double mu=0.0, double sigma=1.0) {
 	}
 }
 
-void randomizeGroups(Graph &origNet, vector<GeneGroup> &groups)
+void randomizeGroups(const CSRGraph &origNet, vector<GeneGroup> &groups)
 {
 	cout << "*** WARNING: Randomizing groups ***" << endl;
 
@@ -2017,11 +2084,11 @@ void randomizeGroups(Graph &origNet, vector<GeneGroup> &groups)
 					which = allGenes[rand()%allGenes.size()];
 			}while(hasAlready);
 			
-			int degWhich = origNet.getNodeDegree(getNodeById(origNet, which));
+			int degWhich = origNet.getNodeDegree(getNodeById(which));
 			while(degCount+degWhich > thisDeg+rand()%100)
 			{
 				which = allGenes[rand()%allGenes.size()];
-				degWhich = origNet.getNodeDegree(getNodeById(origNet, which));
+				degWhich = origNet.getNodeDegree(getNodeById(which));
 			}
 		
 			groups[i].groupGenes.push_back(which);
@@ -2033,13 +2100,11 @@ void randomizeGroups(Graph &origNet, vector<GeneGroup> &groups)
 	
 	/*CONSERVATIVE*/
 	int conn1, randNum, highest = 0;
-	map<int, vector<Graph::Node> > degMap;
-	Graph::Node v1;
+	map<int, vector<CSRGraph::NodeId> > degMap;
 	
-	for (Graph::node_range_t vr = origNet.getNodes(); vr.first != vr.second; vr.first++)
+	for (CSRGraph::NodeId v1 = 0; v1 < (CSRGraph::NodeId)origNet.getNodeCount(); v1++)
 	{
-		v1 = *vr.first;
-		conn1 = DEGREE_BIN((float)origNet.getNodeDegree(v1));
+		conn1 = origNet.getNodeBin(v1);
 		degMap[conn1].push_back(v1);
 		if (conn1 > highest)
 			highest = conn1;
@@ -2047,11 +2112,11 @@ void randomizeGroups(Graph &origNet, vector<GeneGroup> &groups)
 	
 	for (int i = 0; i < (int)groups.size(); i++)
 	{
-		vector<string> origGenes = groups[i].groupGenes;
+		vector<SymbolTable::Symbol> origGenes = groups[i].groupGenes;
 		
 		for (int j = 0; j < (int)groups[i].groupGenes.size(); j++)
 		{
-			conn1 = DEGREE_BIN((float)origNet.getNodeDegree(getNodeById(origNet, groups[i].groupGenes[j])));
+			conn1 = origNet.getNodeBin(getNodeById(groups[i].groupGenes[j]));
 			int k, l;
 			bool hasAlready;
 			do {
@@ -2060,7 +2125,7 @@ void randomizeGroups(Graph &origNet, vector<GeneGroup> &groups)
 				randNum = rand()%(degMap[conn1].size());
 				for (k = 0; k <= j; k++)
 				{
-					if (groups[i].groupGenes[k] == origNet.properties(degMap[conn1][randNum]).geneId)
+					if (groups[i].groupGenes[k] == origNet.getGeneId(degMap[conn1][randNum]))
 					{
 						hasAlready = true;
 						break;
@@ -2069,7 +2134,7 @@ void randomizeGroups(Graph &origNet, vector<GeneGroup> &groups)
 				
 				for (l = 0; l < (int)origGenes.size(); l++)
 				{
-					if (origGenes[l] == origNet.properties(degMap[conn1][randNum]).geneId)
+					if (origGenes[l] == origNet.getGeneId(degMap[conn1][randNum]))
 					{
 						hasAlready = true;
 						break;
@@ -2103,9 +2168,9 @@ void randomizeGroups(Graph &origNet, vector<GeneGroup> &groups)
 			if (hasAlready && k == (int)groups[i].groupGenes.size())
 			{
 				//errGrps[groups[i].groupId] = groups[i].groupId;
-				cout << groups[i].groupId << endl;
+				cout << groupSymbols.getName(groups[i].groupId) << endl;
 			}
-			groups[i].groupGenes[j] = origNet.properties(degMap[conn1][randNum]).geneId;
+			groups[i].groupGenes[j] = origNet.getGeneId(degMap[conn1][randNum]);
 		}
 	}
 }
@@ -29,6 +29,8 @@ various tests that are presented in the paper:
 
 #include "types.h"
 #include "defines.h"
+#include "csrgraph.h"
+#include "randomgraph.h"
 
 using namespace std;
 using namespace boost;
@@ -41,11 +43,19 @@ extern bool useCutoff;
 extern int modeFlag;
 extern bool allVsall;
 extern int methodFlag;
+extern int orderFlag;
 extern int minimumGenesForGroup;
 extern bool doClusteringCoeff;
 extern bool doHyper;
-
-extern map<string, vector<Graph::Node> > geneVertMap; 
+extern int matrixMaxNodes;
+extern double switchesPerLink;
+extern int numThreads;
+extern bool useNetworkCache;
+extern bool useGroupCache;
+extern bool keepLinkWeights;
+extern string networkColumns;
+
+extern vector<CSRGraph::NodeId> geneNodeIds; 
 		
 
 #if VERBOSE
@@ -55,86 +65,128 @@ extern vector<float> smetricRatio;
 
 /****************FUNCTION DECLARATIONS****************/
 
+//reorderNetwork:
+//	Renumbers the nodes of net for cache locality before anything indexed by node id is built,
+//	and reports the bandwidth (largest id difference of a link) before and after.
+//
+//	net: a CSRGraph snapshot of the network loaded from boostgraphio
+//	order: ORDER_FILE, ORDER_DEGREE or ORDER_RCM
+//  ss: a stringstream to print network statistics into, used to print to stdout, info file in main.cpp
+void reorderNetwork(CSRGraph &net, int order, stringstream &ss);
+
 //readGeneGroups:
 //	Loads the gene group table from GeneGroupTableFile and makes a mapping of genes to 
 //	a list of group id's that the each gene belongs to.
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
 //	groups: a vector of GeneGroups in any state to store group information loaded from GeneGroupTableFile
-//	geneGroupMap: a map in any state used for mapping a gene to a vector of group id's that the gene belongs to.
+//	geneGroupMap: a GeneGroupMap in any state, set to the groups of each node of origNet
 //  ss: a stringstream to print group statistics into, used to print to stdout, info file in main.cpp
 //	path: a string containing the file to load group information from
-void readGeneGroups(const Graph &origNet, 
+void readGeneGroups(const CSRGraph &origNet, 
 					vector<GeneGroup> &groups, 
-					map<string, vector<string> > &geneGroupMap, 
+					GeneGroupMap &geneGroupMap, 
 					string path,
 					stringstream &ss);
 
+//buildGeneGroupMap:
+//	Sets geneGroupMap to the groups of each node of net, as indexes into groups. 
+//	readGeneGroups calls it, it is needed again whenever groups changes.
+void buildGeneGroupMap(const CSRGraph &net, const vector<GeneGroup> &groups, GeneGroupMap &geneGroupMap);
+
+//validateConnectivities:
+//	Checks the node connectivities of the randNet network against the connectivities of the origNet network.
+//	Generates a list of errors sorted by size of differences in increasing order.
+//
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
+//	randNet: a RandomGraph to compare with origNet
+//	errors: a vector that afterwards contains the ids of the nodes that have different 
+//			connectivities between origNet and randNet sorted from smallest difference to largest
+//	returns true if randNet has the same connectivities as origNet else false
+bool validateConnectivities(const CSRGraph &origNet, 
+							const RandomGraph &randNet, 
+							vector<CSRGraph::NodeId> &errors);
+
 //generateRandomNetworkLinkSwap:
 //	Swap links as suggested by maslov and sneppen: link pair (a, b) and (c, d) become
-//	(a, c) and (b, d) or (a, d) and (c, b)  
+//	(a, c) and (b, d) or (a, d) and (c, b). switchesPerLink times the number of links
+//	switches are attempted, the ones that would make a self loop or a double link are rejected.
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
-//	randNet: a Graph that is a copy of origNet and is used to store the new randomized version of origNet
-// 	returns the number of swaps performed
-int generateRandomNetworkLinkSwap(const Graph &origNet, Graph &randNet);
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
+//	randNet: a RandomGraph that is a copy of origNet and is used to store the new randomized version of origNet
+// 	returns the number of links switched at least once
+int generateRandomNetworkLinkSwap(const CSRGraph &origNet, RandomGraph &randNet);
 
 //generateRandomNetworkLabelSwap:
 //	Permutates node labels that fall into the same ln(deg) bin.
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
-//	randNet: a Graph in any state that is used to store the new randomized version of origNet
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
+//	randNet: a RandomGraph in any state that is used to store the new randomized version of origNet
 //  degRecordsMap: a map from degree bin to records with that degree bin (from generateMaps below)
 //	returns true if randomization conserved connectivities of the original else false
-bool generateRandomNetworkLabelSwap(const Graph &origNet,
-								Graph &randNet,
+bool generateRandomNetworkLabelSwap(const CSRGraph &origNet,
+								RandomGraph &randNet,
 								map<int, vector<Record> > &degRecordsMap);
 
 //generateRandomNetworkSecondOrder:
 //	Best effort randomization of the original network. Attempts to conserve second-order assortativity.
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
-//	randNet: a Graph in any state that is used to store the new randomized version of origNet
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
+//	randNet: a RandomGraph in any state that is used to store the new randomized version of origNet
 //  degRecordsMap: a map from degree bin to records with that degree bin (from generateMaps below)
 //	returns true if randomization conserved connectivities of the original else false
-bool generateRandomNetworkSecondOrder(const Graph &origNet, 
-						   Graph &randNet,
+bool generateRandomNetworkSecondOrder(const CSRGraph &origNet, 
+						   RandomGraph &randNet,
 						   map<int, vector<Record> > &degRecordsMap);
 
 //generateRandomNetworkAssignment:
 //	Best effort randomization of the original network.
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
-//	randNet: a Graph in any state that is used to store the new randomized version of origNet
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
+//	randNet: a RandomGraph in any state that is used to store the new randomized version of origNet
 //	returns true if randomization conserved connectivities of the original else false
-bool generateRandomNetworkAssignment(const Graph &origNet, 
-						   Graph &randNet);
+bool generateRandomNetworkAssignment(const CSRGraph &origNet, 
+						   RandomGraph &randNet);
 
 //countLinksForGroupsAll:
-//	Calculates links in Graph randNet between groups.
-//	randNet: a randomized Graph with validated connectivities
+//	Calculates links in the network between groups.
+//	net: a CSRGraph, either the network itself or the node set of the links below
+//	links: the links of a randomized network, pairs of node ids of net
 //	groups: a vector containing the list of groups from readGeneGroups
-//	groupStats: a map from group1_vs_group2 string to a vector containing a float for each iteration 
+//	groupStats: a vector indexed by group pair containing a link count for each iteration 
 //				corresponding to the number of links between group1 and group2
-//	geneGroupMap: a map from a gene string to a vector containing group strings that the gene belongs to			
-void countLinksForGroupsAll(Graph &randNet, 
+//	geneGroupMap: the groups of each node of net, from readGeneGroups			
+void countLinksForGroupsAll(const CSRGraph &net, 
+							 const LinkList &links, 
 							 vector<GeneGroup> &groups, 
-							 map<string, Stats > &groupStats,
-							 map<string, vector<string> > &geneGroupMap);
+							 vector<Stats> &groupStats,
+							 GeneGroupMap &geneGroupMap);
+void countLinksForGroupsAll(const CSRGraph &net, 
+							 vector<GeneGroup> &groups, 
+							 vector<Stats> &groupStats,
+							 GeneGroupMap &geneGroupMap);
 
 //countLinksForGroups12:
-//	Counts Links in Graph randNet between groups 1 and 2.
-//	randNet: a randomized Graph with validated connectivities
+//	Counts Links in the network between groups 1 and 2.
+//	net: a CSRGraph, either the network itself or the node set of the links below
+//	links: the links of a randomized network, pairs of node ids of net
 //	groups: a vector containing the list of groups from readGeneGroups
-//	groupStats: a map from group1_vs_group2 string to a vector containing a float for each iteration 
+//	groupStats: a vector indexed by group pair containing a link count for each iteration 
 //				corresponding to the number of links between group1 and group2
-//	geneGroupMap: a map from a gene string to a vector containing group strings that the gene belongs to			
-void countLinksForGroups12(Graph &randNet, 
+//	geneGroupMap: the groups of each node of net, from readGeneGroups			
+void countLinksForGroups12(const CSRGraph &net, 
+							 const LinkList &links, 
+							 vector<GeneGroup> &groups1, 
+							 vector<GeneGroup> &groups2, 
+							 vector<Stats> &groupStats,
+							 GeneGroupMap &geneGroupMap1,
+							 GeneGroupMap &geneGroupMap2);
+void countLinksForGroups12(const CSRGraph &net, 
 							 vector<GeneGroup> &groups1, 
 							 vector<GeneGroup> &groups2, 
-							 map<string, Stats > &groupStats,
-							 map<string, vector<string> > &geneGroupMap1,
-							 map<string, vector<string> > &geneGroupMap2);
+							 vector<Stats> &groupStats,
+							 GeneGroupMap &geneGroupMap1,
+							 GeneGroupMap &geneGroupMap2);
 
 //void countLinks(Graph &origNet, Graph &randNet, Graph &resultsNet, map<string, vector<Graph::Node> > &geneVertMap);
 //void writeConnectivityMatrix(Graph &network);
@@ -143,77 +195,91 @@ void countLinksForGroups12(Graph &randNet,
 //	Calculates the observed and expected links between groups, z score, p value, etc 
 //	and writes it to the file pointed to in path.
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
 //	groups: a vector containing the list of groups from readGeneGroups
-//	groupStats: a map from group1_vs_group2 string to a vector containing a float for each iteration 
+//	groupStats: a vector indexed by group pair containing a link count for each iteration 
 //				corresponding to the number of links between group1 and group2
-//	geneGroupMap: a map from a gene string to a vector containing group strings that the gene belongs to			
+//	geneGroupMap: the groups of each node of net, from readGeneGroups			
 //	path: a string containing the file to write group information to
-void calculateAndWriteResultsAll(Graph &origNet,  
+void calculateAndWriteResultsAll(const CSRGraph &origNet,  
 				  vector<GeneGroup> &groups, 
-				  map<string, Stats > &groupStats,	
-				  map<string, vector<string> > &geneGroupMap,
+				  vector<Stats> &groupStats,	
+				  GeneGroupMap &geneGroupMap,
 				  string path); 
 
 //calculateAndWriteResults12:
 //	Calculates the observed and expected links between groups 1 and 2, z score, p value, etc 
 //	and writes it to the file pointed to in path.
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
 //	groups1: a vector containing the list of groups from readGeneGroups
 //	groups2: a vector containing the list of groups from readGeneGroups
-//	groupStats: a map from group1_vs_group2 string to a vector containing a float for each iteration 
+//	groupStats: a vector indexed by group pair containing a link count for each iteration 
 //				corresponding to the number of links between group1 and group2
-//	geneGroupMap1: a map from a gene string to a vector containing group strings that the gene belongs to			
-//	geneGroupMap2: a map from a gene string to a vector containing group strings that the gene belongs to			
+//	geneGroupMap1: maps a gene symbol to the symbols of the groups that the gene belongs to			
+//	geneGroupMap2: maps a gene symbol to the symbols of the groups that the gene belongs to			
 //	path: a string containing the file to write group information to
-void calculateAndWriteResults12(Graph &origNet,  
+void calculateAndWriteResults12(const CSRGraph &origNet,  
 				  vector<GeneGroup> &groups1, 
 				  vector<GeneGroup> &groups2, 
-				  map<string, Stats > &groupStats,	
-				  map<string, vector<string> > &geneGroupMap1,
-				  map<string, vector<string> > &geneGroupMap2,
+				  vector<Stats> &groupStats,	
+				  GeneGroupMap &geneGroupMap1,
+				  GeneGroupMap &geneGroupMap2,
 				  string path); 
 					
 //generateMaps:
 //	Create maps that can be used for quickly accessing  elements or records given 
-//	a  id string or degree bin respectively. (this function creates geneVertMap and degRecordsMap)
+//	a  id string or degree bin respectively. (this function creates geneNodeIds and degRecordsMap)
 //
-//	origNet: a Graph that contains the network loaded from boostgraphio
-//	randNet: a Graph in any state that is used to store the new randomized version of origNet
+//	origNet: a CSRGraph snapshot of the network loaded from boostgraphio
 //  degRecordsMap: a map from degree bin to records with that degree bin (from generateMaps below)
-void generateMaps(Graph &origNet, 
-				  Graph &randNet, 
+void generateMaps(const CSRGraph &origNet, 
 				  map<int, vector<Record> > &degRecordsMap); 	
 
 
 
 //utility functions
-Graph::Node getNodeById(const Graph &g, const string &Id);
+CSRGraph::NodeId getNodeById(SymbolTable::Symbol gene);
 void printNetwork(const Graph &network);
 string getMethodString(int m);
+string getOrderString(int o);
 int getTotalInputUniqueGeneCount(string path1, string path2);
-void copyOrigToRand( Graph &origNet, Graph &randNet);//Need special copy function to preserve  and link data.
+
+//countSharedGenes:
+//	Sets kSuccess[pair] to the number of genes the groups of each pair share, for --phyper.
+//	all: groups2 is groups1 and pairs are indexed by pairIndexAll, else by pairIndex12.
+//	Pairs sharing no genes are left alone, kSuccess must be zeroed and sized to the pair count.
+void countSharedGenes(const vector<GeneGroup> &groups1, const vector<GeneGroup> &groups2, bool all, vector<int> &kSuccess);
+
+void copyOrigToRand(const CSRGraph &origNet, RandomGraph &randNet);//resets randNet to the links of origNet
+
+//getRandomLinkWeights:
+//	The weights of the links of randNet, parallel to randNet.getLinks(), for writing it out. A link
+//	has the weight of the link of origNet that it stands for, the link between the nodes whose labels
+//	its nodes carry, and weight 1 if origNet has no such link. Empty if origNet has no weights.
+void getRandomLinkWeights(const CSRGraph &origNet, const RandomGraph &randNet, vector<float> &weights);
 
 
 //statistics functions
-float calculateRfromNetwork(const Graph &g);
-long long calculateSmetricNetwork(const Graph &g);
+float calculateRfromNetwork(const RandomGraph &g);
+long long calculateSmetricNetwork(const RandomGraph &g);
+long long calculateSmetricNetwork(const CSRGraph &g);
+float calculateRfromNetwork(const CSRGraph &g);
 int calculateSmetricNode(const Graph &g, Graph::Node v);
-float calculateClusteringCoeffForTwoGroups(const Graph &graph, const GeneGroup &group1, const GeneGroup &group2);
-float calculateClusteringCoeffForGroup(const Graph &graph, const GeneGroup &group);
-float calculateClusteringCoeffForGroupOnly(const Graph &graph, const GeneGroup &group);
+float calculateClusteringCoeffForTwoGroups(const CSRGraph &graph, const GeneGroup &group1, const GeneGroup &group2);
+float calculateClusteringCoeffForGroup(const CSRGraph &graph, const GeneGroup &group);
+float calculateClusteringCoeffForGroupOnly(const CSRGraph &graph, const GeneGroup &group);
 
 
 
 
 #if RAND_GROUPS
-void randomizeGroups(Graph &origNet,
+void randomizeGroups(const CSRGraph &origNet,
 					vector<GeneGroup> &groups); 
 #endif
 
 #if SPLIT_GROUPS
-void splitGroups(vector<GeneGroup> &groups, map<string, vector<string> > &geneGroupMap);
+void splitGroups(const CSRGraph &origNet, vector<GeneGroup> &groups, GeneGroupMap &geneGroupMap);
 #endif
 
 
@@ -0,0 +1,407 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the CSRGraph class, an immutable compressed sparse row
+snapshot of a loaded Graph. Nodes are renumbered to dense ids 0..N-1 in the
+node order of the source Graph, and every node's neighbors are stored sorted
+in one contiguous array so that degree, adjacency and link tests do not have
+to chase pointers through the boost::graph containers. Link weights are kept
+in an array parallel to the neighbors only if the snapshot is built weighted.
+Per node data is split by use: the degree, degree bin and gene symbol that
+the randomization and counting loops read on every visit are packed together
+in one hot array, while gene names stay cold in the symbol table. The snapshot
+keeps no reference to the source Graph, which can be freed once it is built.
+The ids can afterwards be permuted into a cache friendlier order, by
+decreasing degree or by reverse Cuthill-McKee, which keeps the neighbors of a
+node close to it in id order and so close in every array indexed by id.
+
+*/
+
+#ifndef __CSRGRAPH_H__
+#define __CSRGRAPH_H__
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include <math.h>
+#include <boost/unordered_map.hpp>
+
+#include "defines.h"
+#include "types.h"
+
+using namespace std;
+
+class CSRGraph
+{
+public:
+	typedef uint32_t NodeId;
+	static const NodeId NONE = 0xffffffff;
+	typedef std::pair<const NodeId*, const NodeId*> adjacency_node_range_t;
+
+	CSRGraph(){linkCount = 0; weighted = false;}
+	CSRGraph(const Graph &g, const LinkWeights *linkWeights = NULL){build(g, linkWeights);}
+	~CSRGraph(){}
+
+	//build:
+	//	Freezes g into this snapshot. Node ids follow the node iteration order of g.
+	//	The snapshot is weighted if linkWeights is given, with the weights of the links of g
+	//	by node pair (v1 < v2), see BoostGraphIO::getLinkWeights.
+	void build(const Graph &g, const LinkWeights *linkWeights = NULL)
+	{
+		boost::unordered_map<Graph::Node, NodeId> nodeIds;
+		vector<pair<NodeId, float> > adjacency;
+		vector<uint32_t> fill;
+		Graph::Node v1, v2;
+		NodeId n = 0;
+		HotNode h;
+
+		clear();
+		weighted = (linkWeights != NULL);
+		nodeIds.rehash(g.getNodeCount());
+		h.degree = 0;
+		h.bin = 0;
+		for (Graph::node_range_t vr = g.getNodes(); vr.first != vr.second; vr.first++)
+		{
+			nodeIds[*vr.first] = n++;
+			h.geneId = g.properties(*vr.first).geneId;
+			hot.push_back(h);
+		}
+
+		for (Graph::link_range_t er = g.getLinks(); er.first != er.second; er.first++)
+		{
+			g.getNodesByLink(*er.first, v1, v2);
+			hot[nodeIds[v1]].degree++;
+			hot[nodeIds[v2]].degree++;
+		}
+
+		offsets.resize(n+1, 0);
+		for (NodeId v = 0; v < n; v++)
+		{
+			hot[v].bin = DEGREE_BIN(hot[v].degree);
+			offsets[v+1] = offsets[v] + hot[v].degree;
+		}
+
+		fill.assign(offsets.begin(), offsets.end()-1);
+		adjacency.resize(offsets[n]);
+		for (Graph::link_range_t er = g.getLinks(); er.first != er.second; er.first++)
+		{
+			g.getNodesByLink(*er.first, v1, v2);
+			NodeId a = nodeIds[v1], b = nodeIds[v2];
+			float w = 1;
+			if (weighted)
+			{
+				LinkWeights::const_iterator it = linkWeights->find(v1 < v2 ? make_pair(v1, v2) : make_pair(v2, v1));
+				if (it != linkWeights->end())
+					w = it->second;
+			}
+			adjacency[fill[a]++] = pair<NodeId, float>(b, w);
+			adjacency[fill[b]++] = pair<NodeId, float>(a, w);
+		}
+
+		neighbors.resize(adjacency.size());
+		if (weighted)
+			weights.resize(adjacency.size());
+		for (NodeId v = 0; v < n; v++)
+		{
+			sort(adjacency.begin()+offsets[v], adjacency.begin()+offsets[v+1]);
+			for (uint32_t k = offsets[v]; k < offsets[v+1]; k++)
+				neighbors[k] = adjacency[k].first;
+			if (weighted)
+				for (uint32_t k = offsets[v]; k < offsets[v+1]; k++)
+					weights[k] = adjacency[k].second;
+		}
+		linkCount = g.getLinkCount();
+	}
+
+	//build:
+	//	Takes over ready made arrays, as stored in a network cache: node v is gene genes[v] and its
+	//	neighbors, sorted, are nbrs[offs[v]..offs[v+1]) with weights wts, if weighted.
+	//	The arguments are left empty.
+	void build(vector<SymbolTable::Symbol> &genes, vector<uint32_t> &offs, vector<NodeId> &nbrs, vector<float> &wts, bool weighted)
+	{
+		HotNode h;
+
+		clear();
+		this->weighted = weighted;
+		for (NodeId v = 0; v < (NodeId)genes.size(); v++)
+		{
+			h.geneId = genes[v];
+			h.degree = offs[v+1] - offs[v];
+			h.bin = DEGREE_BIN(h.degree);
+			hot.push_back(h);
+		}
+		offsets.swap(offs);
+		neighbors.swap(nbrs);
+		if (weighted)
+			weights.swap(wts);
+		linkCount = neighbors.size()/2;
+		genes.clear();
+		offs.clear();
+		nbrs.clear();
+		wts.clear();
+	}
+
+	//permute:
+	//	Renumbers the nodes so that node order[k] of the current numbering becomes node k.
+	void permute(const vector<NodeId> &order)
+	{
+		NodeId n = order.size();
+		vector<NodeId> newIds(n);
+		vector<uint32_t> newOffsets(n+1, 0);
+		vector<NodeId> newNeighbors(neighbors.size());
+		vector<HotNode> newHot(n);
+		vector<float> newWeights(weights.size());
+		vector<pair<NodeId, float> > adjacency;
+
+		for (NodeId k = 0; k < n; k++)
+			newIds[order[k]] = k;
+
+		for (NodeId k = 0; k < n; k++)
+		{
+			NodeId v = order[k];
+			newHot[k] = hot[v];
+			newOffsets[k+1] = newOffsets[k] + hot[v].degree;
+
+			if (weighted)
+			{
+				//the weights move with their neighbors
+				adjacency.clear();
+				for (uint32_t i = offsets[v]; i < offsets[v+1]; i++)
+					adjacency.push_back(pair<NodeId, float>(newIds[neighbors[i]], weights[i]));
+				sort(adjacency.begin(), adjacency.end());
+				for (uint32_t i = 0; i < adjacency.size(); i++)
+				{
+					newNeighbors[newOffsets[k]+i] = adjacency[i].first;
+					newWeights[newOffsets[k]+i] = adjacency[i].second;
+				}
+			}
+			else
+			{
+				for (uint32_t i = offsets[v]; i < offsets[v+1]; i++)
+					newNeighbors[newOffsets[k]+i-offsets[v]] = newIds[neighbors[i]];
+				sort(newNeighbors.begin()+newOffsets[k], newNeighbors.begin()+newOffsets[k+1]);
+			}
+		}
+
+		offsets.swap(newOffsets);
+		neighbors.swap(newNeighbors);
+		weights.swap(newWeights);
+		hot.swap(newHot);
+	}
+
+	//degreeOrder:
+	//	Returns the node ids by decreasing degree, ties in id order, for permute.
+	//	The hubs that every loop visits most end up packed together at the front.
+	vector<NodeId> degreeOrder() const
+	{
+		vector<pair<int, NodeId> > byDegree;
+		vector<NodeId> order;
+
+		for (NodeId v = 0; v < (NodeId)getNodeCount(); v++)
+			byDegree.push_back(pair<int, NodeId>(-(int)hot[v].degree, v));
+		sort(byDegree.begin(), byDegree.end());
+		for (int k = 0; k < (int)byDegree.size(); k++)
+			order.push_back(byDegree[k].second);
+		return order;
+	}
+
+	//rcmOrder:
+	//	Returns the reverse Cuthill-McKee order of the nodes for permute. Every connected
+	//	component is searched breadth first from one of its nodes of lowest degree, visiting
+	//	the unvisited neighbors of a node by increasing degree, and the whole order is reversed.
+	vector<NodeId> rcmOrder() const
+	{
+		NodeId n = getNodeCount();
+		vector<NodeId> order, byDegree(n), children;
+		vector<bool> visited(n, false);
+
+		order.reserve(n);
+		for (NodeId v = 0; v < n; v++)
+			byDegree[v] = v;
+		stable_sort(byDegree.begin(), byDegree.end(), DegreeLess(hot));
+
+		for (NodeId s = 0; s < n; s++)
+		{
+			if (visited[byDegree[s]])
+				continue;
+
+			//order doubles as the breadth first queue of the component
+			visited[byDegree[s]] = true;
+			order.push_back(byDegree[s]);
+			for (NodeId head = order.size()-1; head < order.size(); head++)
+			{
+				children.clear();
+				for (adjacency_node_range_t avr = getAdjacentNodes(order[head]); avr.first != avr.second; avr.first++)
+					if (!visited[*avr.first])
+					{
+						visited[*avr.first] = true;
+						children.push_back(*avr.first);
+					}
+				stable_sort(children.begin(), children.end(), DegreeLess(hot));
+				order.insert(order.end(), children.begin(), children.end());
+			}
+		}
+
+		reverse(order.begin(), order.end());
+		return order;
+	}
+
+	//the largest difference between the ids of two linked nodes
+	int getBandwidth() const
+	{
+		int bandwidth = 0;
+		for (NodeId v = 0; v < (NodeId)getNodeCount(); v++)
+			if (offsets[v] != offsets[v+1])
+			{
+				//neighbors are sorted, so the farthest is at one of the ends
+				bandwidth = max(bandwidth, abs((int)v - (int)neighbors[offsets[v]]));
+				bandwidth = max(bandwidth, abs((int)v - (int)neighbors[offsets[v+1]-1]));
+			}
+		return bandwidth;
+	}
+
+	void clear()
+	{
+		offsets.clear();
+		neighbors.clear();
+		weights.clear();
+		hot.clear();
+		linkCount = 0;
+		weighted = false;
+	}
+
+	/* selectors and properties */
+	int getNodeCount() const
+	{
+		return (int)hot.size();
+	}
+
+	int getLinkCount() const
+	{
+		return linkCount;
+	}
+
+	int getNodeDegree(NodeId v) const
+	{
+		return hot[v].degree;
+	}
+
+	//DEGREE_BIN of the degree of v
+	int getNodeBin(NodeId v) const
+	{
+		return hot[v].bin;
+	}
+
+	//neighbors of v in increasing id order
+	adjacency_node_range_t getAdjacentNodes(NodeId v) const
+	{
+		return adjacency_node_range_t(neighbors.data()+offsets[v], neighbors.data()+offsets[v+1]);
+	}
+
+	//getLinkNeighbors:
+	//	The neighbors of v from v on, with a link of v to itself once (it is stored twice). Over all
+	//	nodes these visit every link once, from its endpoint with the lower id.
+	adjacency_node_range_t getLinkNeighbors(NodeId v) const
+	{
+		adjacency_node_range_t avr = getAdjacentNodes(v);
+		avr.first = lower_bound(avr.first, avr.second, v);
+		if (avr.first != avr.second && *avr.first == v)
+			avr.first++;
+		return avr;
+	}
+
+	//true if the snapshot keeps link weights
+	bool hasWeights() const
+	{
+		return weighted;
+	}
+
+	//weights of the links to the neighbors of v, parallel to getAdjacentNodes(v), if hasWeights
+	const float* getAdjacentWeights(NodeId v) const
+	{
+		return weights.data()+offsets[v];
+	}
+
+	//the weight of the link between v1 and v2, none if there is no such link or no weights
+	float getLinkWeight(NodeId v1, NodeId v2, float none) const
+	{
+		if (!weighted)
+			return none;
+		adjacency_node_range_t avr = getAdjacentNodes(v1);
+		const NodeId *at = lower_bound(avr.first, avr.second, v2);
+		if (at == avr.second || *at != v2)
+			return none;
+		return weights[at-neighbors.data()];
+	}
+
+	bool hasLink(NodeId v1, NodeId v2) const
+	{
+		if (hot[v1].degree > hot[v2].degree)
+			std::swap(v1, v2);
+		adjacency_node_range_t avr = getAdjacentNodes(v1);
+		return binary_search(avr.first, avr.second, v2);
+	}
+
+	SymbolTable::Symbol getGeneId(NodeId v) const
+	{
+		return hot[v].geneId;
+	}
+
+	//the raw arrays, for writing the snapshot out
+	const vector<uint32_t>& getOffsets() const
+	{
+		return offsets;
+	}
+
+	const vector<NodeId>& getNeighbors() const
+	{
+		return neighbors;
+	}
+
+	//empty unless hasWeights
+	const vector<float>& getWeights() const
+	{
+		return weights;
+	}
+
+protected:
+	//the per node data read by the inner loops, 12 bytes a node
+	struct HotNode
+	{
+		uint32_t degree;
+		int32_t bin;	//DEGREE_BIN(degree)
+		SymbolTable::Symbol geneId;	//key of the node's groups in a GeneGroupMap
+	};
+
+	struct DegreeLess
+	{
+		DegreeLess(const vector<HotNode> &h) : hot(h) {}
+		bool operator()(NodeId v1, NodeId v2) const {return hot[v1].degree < hot[v2].degree;}
+		const vector<HotNode> &hot;
+	};
+
+	vector<uint32_t> offsets;	//node v's neighbors are neighbors[offsets[v]..offsets[v+1])
+	vector<NodeId> neighbors;
+	vector<float> weights;	//parallel to neighbors, empty unless weighted
+	vector<HotNode> hot;
+	int linkCount;
+	bool weighted;
+};
+
+#endif
@@ -29,7 +29,7 @@ Preprocessor definitions utilized throughout the CrossTalkZ program.
 #define FUNCOUP_PROTEIN1		5
 #define FUNCOUP_PROTEIN2		6
 
-//A groups file should have format: Protein\tGroup\t[System, Species, Description]
+//A groups file should have format: Protein\tGroup\t[System, Species, Description], unless it is a .gmt file
 #define GROUP_GENE	0
 #define GROUP_ID		1
 #define GROUP_SYS		2
@@ -50,6 +50,29 @@ Preprocessor definitions utilized throughout the CrossTalkZ program.
 #define METHOD_LABELSWAP		3
 #define METHOD_DEFAULT		METHOD_ASSIGN_SECOND
 
+//node id order of the network snapshot, chosen for cache locality
+#define ORDER_FILE		0 //order the nodes were read in
+#define ORDER_DEGREE		1 //decreasing degree
+#define ORDER_RCM		2 //reverse Cuthill-McKee
+#define ORDER_DEFAULT		ORDER_RCM
+
+//the degree bin of a node with degree x, nodes are only exchanged within a bin
+#define DEGREE_BIN(x)		((int)round(log(x)+1))
+
+//random networks with at most this many nodes test links with an n x n bit matrix
+//instead of a hash set, 4096 nodes is a 2MB matrix
+#define MATRIX_MAX_NODES_DEFAULT	4096
+
+//link switches attempted by METHOD_LINKSWAP per link of the network
+#define LINKSWAP_SWITCHES_DEFAULT	2
+//and how many switches ahead their links are loaded into the cache
+#define LINKSWAP_PREFETCH	16
+
+//a loaded network is cached in binary next to its file, in <network file>NETWORK_CACHE_SUFFIX
+#define NETWORK_CACHE_SUFFIX	".ctzcache"
+//and a loaded group file in <group file>GROUP_CACHE_SUFFIX
+#define GROUP_CACHE_SUFFIX	".ctzgroups"
+
 #define VERSION		"1.3.3"
 
 #define DEBUG		0
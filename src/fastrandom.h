@@ -0,0 +1,80 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the FastRandom class, the xoshiro256** generator of
+Blackman and Vigna seeded through splitmix64, for randomizers that draw
+millions of numbers. rand() gives 31 bits at most and rand()%n favors small
+values of n's range; below(n) maps 64 random bits onto [0, n) with one
+multiplication.
+
+*/
+
+#ifndef __FASTRANDOM_H__
+#define __FASTRANDOM_H__
+
+#include <stdint.h>
+
+class FastRandom
+{
+public:
+	FastRandom(uint64_t seed = 0){this->seed(seed);}
+	~FastRandom(){}
+
+	//seed: any seed, 0 too, gives a usable state
+	void seed(uint64_t seed)
+	{
+		for (int k = 0; k < 4; k++)
+		{
+			//splitmix64
+			uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			s[k] = z ^ (z >> 31);
+		}
+	}
+
+	//the next 64 random bits
+	uint64_t next()
+	{
+		uint64_t result = rotl(s[1]*5, 7)*9, t = s[1] << 17;
+
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	//a random number in [0, n), n > 0
+	uint32_t below(uint32_t n)
+	{
+		return (uint32_t)(((unsigned __int128)next() * n) >> 64);
+	}
+
+protected:
+	static uint64_t rotl(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64-k));
+	}
+
+	uint64_t s[4];
+};
+
+#endif
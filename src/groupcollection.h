@@ -0,0 +1,485 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the GroupCollection class, the groups of one group file
+as they are in the file, before the network decides which genes and groups
+are used. A group file is either the one gene per line table of the data
+directory (gene, group, system, species, description) or, if its name ends
+in .gmt, a GMT file with one group per line (group, description, genes...).
+The parsed collection is kept in binary next to the group file, in
+<group file>GROUP_CACHE_SUFFIX, and read from there while the file does not
+change.
+
+*/
+
+#ifndef __GROUPCOLLECTION_H__
+#define __GROUPCOLLECTION_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include "symboltable.h"
+#include "mappedfile.h"
+#include "inputstream.h"
+#include "textscan.h"
+#include "defines.h"
+
+using namespace std;
+
+//the fixed part at the start of a group cache file, followed by
+//uint32 geneLengths[geneCount], char geneNames[geneBytes], uint32 textLengths[4*groupCount],
+//char texts[textBytes] (id, species, system and description of each group),
+//the names and texts each zero padded to a multiple of 4 bytes,
+//uint32 offsets[groupCount+1] and uint32 members[memberCount]
+struct GroupCacheHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;
+	uint64_t sourceSize;
+	int64_t sourceMtimeSec;
+	int64_t sourceMtimeNsec;
+	uint64_t sourceHash;
+	uint64_t geneCount;
+	uint64_t geneBytes;
+	uint64_t groupCount;
+	uint64_t textBytes;
+	uint64_t memberCount;
+};
+
+#define GROUP_CACHE_MAGIC		"CTZGRP\0\0"
+#define GROUP_CACHE_VERSION	2
+#define GROUP_CACHE_GMT		1 //the file was read as GMT
+//the padded size of a block of n name bytes, which keeps the uint32 arrays 4 byte aligned
+#define GROUP_CACHE_PADDED(n)	(((n) + 3) & ~(uint64_t)3)
+
+class GroupCollection
+{
+public:
+	GroupCollection(){}
+	~GroupCollection(){}
+
+	//isGMTPath: true if the file at path is read as GMT, a name ending in .gmt, possibly compressed
+	static bool isGMTPath(string path)
+	{
+		boost::algorithm::to_lower(path);
+		for (const char *ext : {".gz", ".zst"})
+			if (path.size() > strlen(ext) && !path.compare(path.size()-strlen(ext), strlen(ext), ext))
+				path.resize(path.size()-strlen(ext));
+		return path.size() > 4 && !path.compare(path.size()-4, 4, ".gmt");
+	}
+
+	//load:
+	//	Reads the group file at path, from its cache if useCache and the cache is still valid.
+	//	A parsed file is cached if useCache. Exits if the file can not be opened.
+	void load(const string &path, bool useCache)
+	{
+		if (useCache && readCache(path))
+			return;
+		if (isGMTPath(path))
+			readGMT(path);
+		else
+			readTable(path);
+		if (useCache)
+			writeCache(path);
+	}
+
+	int getGroupCount() const
+	{
+		return groupIds.size();
+	}
+
+	//the genes of group i in file order as indexes into genes, [first, last)
+	const uint32_t* getMembersBegin(int i) const
+	{
+		return members.data()+offsets[i];
+	}
+
+	const uint32_t* getMembersEnd(int i) const
+	{
+		return members.data()+offsets[i+1];
+	}
+
+	vector<SymbolTable::Symbol> genes;	//the unique genes of the file in first seen order, symbols in geneSymbols
+	vector<SymbolTable::Symbol> groupIds;	//the groups in first seen order, symbols in groupSymbols
+	vector<string> groupSpe, groupSys, groupDesc;	//by group, from the first line of the group
+	vector<uint32_t> offsets;	//group -> first of its entries in members, groupCount+1 entries
+	vector<uint32_t> members;	//indexes into genes, a gene listed twice in a group is there twice
+
+protected:
+	void clear()
+	{
+		genes.clear();
+		groupIds.clear();
+		groupSpe.clear();
+		groupSys.clear();
+		groupDesc.clear();
+		offsets.clear();
+		members.clear();
+		geneIndex.clear();
+		groupIndex.clear();
+		pairs.clear();
+	}
+
+	//the index of gene in genes, added if new
+	uint32_t addGene(SymbolTable::Symbol gene)
+	{
+		if (gene >= geneIndex.size())
+			geneIndex.resize(geneSymbols.size(), -1);
+		if (geneIndex[gene] < 0)
+		{
+			geneIndex[gene] = genes.size();
+			genes.push_back(gene);
+		}
+		return geneIndex[gene];
+	}
+
+	//the index of group in groupIds, added with empty texts if new, new is set if so
+	uint32_t addGroup(SymbolTable::Symbol group, bool &isNew)
+	{
+		if (group >= groupIndex.size())
+			groupIndex.resize(groupSymbols.size(), -1);
+		isNew = (groupIndex[group] < 0);
+		if (isNew)
+		{
+			groupIndex[group] = groupIds.size();
+			groupIds.push_back(group);
+			groupSpe.push_back(string());
+			groupSys.push_back(string());
+			groupDesc.push_back(string());
+		}
+		return groupIndex[group];
+	}
+
+	//makes offsets and members from the (group, gene) pairs read, keeping the file order in each group
+	void buildMembers()
+	{
+		vector<uint32_t> next;
+		size_t k;
+
+		offsets.assign(groupIds.size()+1, 0);
+		for (k = 0; k < pairs.size(); k++)
+			offsets[pairs[k].first+1]++;
+		for (k = 0; k < groupIds.size(); k++)
+			offsets[k+1] += offsets[k];
+		next.assign(offsets.begin(), offsets.end()-1);
+		members.resize(pairs.size());
+		for (k = 0; k < pairs.size(); k++)
+			members[next[pairs[k].first]++] = pairs[k].second;
+		geneIndex.clear();
+		groupIndex.clear();
+		pairs.clear();
+	}
+
+	void openFile(InputStream &file, const string &path)
+	{
+		if (!file.open(path))
+		{
+			cout << "Error in opening "<< path << endl;
+			exit(1);
+		}
+		cout << endl <<"Reading groups from "<< path << " ..." << endl;
+	}
+
+	//readTable:
+	//	Reads the one gene per line table, fields separated by any of ',', ' ' and '\t'.
+	//	Lines with fewer than two fields are skipped.
+	void readTable(const string &path)
+	{
+		InputStream file;
+		string line, geneID, groupID;
+		vector<TextSlice> lineVals; //the fields of line
+		const DelimiterSet groupDelimiters(',', ' ', '\t');
+		uint32_t group;
+		bool isNew;
+
+		clear();
+		openFile(file, path);
+		while(file.getline(line))
+		{
+			//empty fields are dropped, runs of delimiters count as one
+			if (splitFields(line, groupDelimiters, lineVals) < 2)
+				continue;
+
+			upperCopy(trimRight(lineVals[GROUP_GENE]), geneID);
+			upperCopy(trimRight(lineVals[GROUP_ID]), groupID);
+			group = addGroup(groupSymbols.intern(groupID), isNew);
+			if (isNew)
+			{
+				//the first line of a group gives its description
+				if (lineVals.size() > GROUP_SPE){
+					TextSlice spe = trimRight(lineVals[GROUP_SPE]);
+					groupSpe[group].assign(spe.first, spe.last);
+					boost::algorithm::to_lower(groupSpe[group]);
+				}
+				if (lineVals.size() > GROUP_SYS)
+					upperCopy(trimRight(lineVals[GROUP_SYS]), groupSys[group]);
+				if (lineVals.size() > GROUP_DESC){
+					TextSlice desc = trimRight(lineVals[GROUP_DESC]);
+					groupDesc[group].assign(desc.first, desc.last);
+				}
+			}
+			pairs.push_back(make_pair(group, addGene(geneSymbols.intern(geneID))));
+		}
+		file.close();
+		buildMembers();
+	}
+
+	//readGMT:
+	//	Reads a GMT file, tab separated lines of group name, description and the genes of the group.
+	//	Empty fields are skipped, a group on several lines gets the genes of all of them.
+	void readGMT(const string &path)
+	{
+		InputStream file;
+		string line, name;
+		vector<TextSlice> lineVals;
+		const DelimiterSet tab('\t');
+		uint32_t group;
+		bool isNew;
+		int k;
+
+		clear();
+		openFile(file, path);
+		while(file.getline(line))
+		{
+			if (splitFields(line, tab, lineVals) < 3)
+				continue;
+
+			upperCopy(trimRight(lineVals[0]), name);
+			group = addGroup(groupSymbols.intern(name), isNew);
+			if (isNew)
+			{
+				TextSlice desc = trimRight(lineVals[1]);
+				groupDesc[group].assign(desc.first, desc.last);
+			}
+			for (k = 2; k < (int)lineVals.size(); k++)
+			{
+				upperCopy(trimRight(lineVals[k]), name);
+				if (!name.empty())
+					pairs.push_back(make_pair(group, addGene(geneSymbols.intern(name))));
+			}
+		}
+		file.close();
+		buildMembers();
+	}
+
+	//getCacheKey:
+	//	Fills in the fields of h that must match for a cache of the group file at path to be reused,
+	//	the content hash of the file only if withHash. Returns false if the file can not be read.
+	static bool getCacheKey(const string &path, GroupCacheHeader &h, bool withHash)
+	{
+		MappedFile source;
+		struct stat st;
+
+		if (stat(path.c_str(), &st) < 0)
+			return false;
+		memcpy(h.magic, GROUP_CACHE_MAGIC, sizeof(h.magic));
+		h.version = GROUP_CACHE_VERSION;
+		h.flags = isGMTPath(path) ? GROUP_CACHE_GMT : 0;
+		h.sourceSize = st.st_size;
+		h.sourceMtimeSec = st.st_mtim.tv_sec;
+		h.sourceMtimeNsec = st.st_mtim.tv_nsec;
+		if (!withHash)
+			return true;
+		if (!source.open(path))
+			return false;
+		h.sourceHash = hashBytes(source.begin(), source.size());
+		return true;
+	}
+
+	//validCache:
+	//	True if the arrays of a group cache of the size its header h gives, starting at body, agree with the
+	//	header: the gene name and text lengths add up to geneBytes and textBytes, the offsets rise from 0 to
+	//	memberCount and the members are genes. A cache damaged in place keeps its size and key, this keeps it
+	//	from being used.
+	static bool validCache(const GroupCacheHeader &h, const char *body)
+	{
+		const uint32_t *lengths = (const uint32_t*)body, *offsets, *ids;
+		uint64_t bytes = 0, k;
+		
+		for (k = 0; k < h.geneCount; k++)
+			bytes += lengths[k];
+		if (bytes != h.geneBytes)
+			return false;
+		lengths = (const uint32_t*)(body + 4*h.geneCount + GROUP_CACHE_PADDED(h.geneBytes));
+		bytes = 0;
+		for (k = 0; k < 4*h.groupCount; k++)
+			bytes += lengths[k];
+		if (bytes != h.textBytes)
+			return false;
+		offsets = (const uint32_t*)((const char*)(lengths + 4*h.groupCount) + GROUP_CACHE_PADDED(h.textBytes));
+		if (offsets[0] != 0 || offsets[h.groupCount] != h.memberCount)
+			return false;
+		for (k = 0; k < h.groupCount; k++)
+			if (offsets[k+1] < offsets[k])
+				return false;
+		ids = offsets + h.groupCount+1;
+		for (k = 0; k < h.memberCount; k++)
+			if (ids[k] >= h.geneCount)
+				return false;
+		return true;
+	}
+
+	//readCache:
+	//	Fills the collection from the cache of the group file at path and interns its names. Returns false,
+	//	leaving the collection alone, if there is no cache, the file changed since it was written or the arrays
+	//	of the cache do not agree with its header.
+	bool readCache(const string &path)
+	{
+		MappedFile cache;
+		GroupCacheHeader stored, current;
+		const uint32_t *lengths, *ids;
+		const char *text, *block;
+		uint64_t expected, k;
+
+		if (!cache.open(path + GROUP_CACHE_SUFFIX) || cache.size() < sizeof(stored))
+			return false;
+		memcpy(&stored, cache.begin(), sizeof(stored));
+		current = stored;
+		if (memcmp(stored.magic, GROUP_CACHE_MAGIC, sizeof(stored.magic)) || stored.version != GROUP_CACHE_VERSION)
+			return false;
+
+		//size and time first, the content hash only if they still match
+		if (!getCacheKey(path, current, false) || current.sourceSize != stored.sourceSize || current.flags != stored.flags
+			|| current.sourceMtimeSec != stored.sourceMtimeSec || current.sourceMtimeNsec != stored.sourceMtimeNsec)
+			return false;
+		if (!getCacheKey(path, current, true) || current.sourceHash != stored.sourceHash)
+			return false;
+
+		//the counts bound the sizes below, so that corrupted counts can not wrap them around
+		if (stored.geneCount > cache.size() || stored.geneBytes > cache.size() || stored.groupCount > cache.size()
+			|| stored.textBytes > cache.size() || stored.memberCount > cache.size())
+			return false;
+		expected = sizeof(stored) + 4*stored.geneCount + GROUP_CACHE_PADDED(stored.geneBytes) + 16*stored.groupCount
+			+ GROUP_CACHE_PADDED(stored.textBytes)
+			+ 4*(stored.groupCount+1) + 4*stored.memberCount;
+		if (cache.size() != expected)
+			return false;
+		if (!validCache(stored, cache.begin() + sizeof(stored)))
+			return false;
+
+		cout << endl << "Reading groups from cache " << path + GROUP_CACHE_SUFFIX << " ..." << endl;
+		clear();
+		lengths = (const uint32_t*)(cache.begin() + sizeof(stored));
+		block = text = (const char*)(lengths + stored.geneCount);
+		genes.resize(stored.geneCount);
+		for (k = 0; k < stored.geneCount; k++)
+		{
+			genes[k] = geneSymbols.intern(text, lengths[k]);
+			text += lengths[k];
+		}
+
+		lengths = (const uint32_t*)(block + GROUP_CACHE_PADDED(stored.geneBytes));
+		block = text = (const char*)(lengths + 4*stored.groupCount);
+		groupIds.resize(stored.groupCount);
+		groupSpe.resize(stored.groupCount);
+		groupSys.resize(stored.groupCount);
+		groupDesc.resize(stored.groupCount);
+		for (k = 0; k < stored.groupCount; k++)
+		{
+			groupIds[k] = groupSymbols.intern(text, lengths[4*k]);
+			text += lengths[4*k];
+			groupSpe[k].assign(text, lengths[4*k+1]);
+			text += lengths[4*k+1];
+			groupSys[k].assign(text, lengths[4*k+2]);
+			text += lengths[4*k+2];
+			groupDesc[k].assign(text, lengths[4*k+3]);
+			text += lengths[4*k+3];
+		}
+
+		ids = (const uint32_t*)(block + GROUP_CACHE_PADDED(stored.textBytes));
+		offsets.assign(ids, ids + stored.groupCount+1);
+		ids += stored.groupCount+1;
+		members.assign(ids, ids + stored.memberCount);
+		return true;
+	}
+
+	//writes the cache of the group file at path, replacing any older cache
+	void writeCache(const string &path) const
+	{
+		GroupCacheHeader h;
+		vector<uint32_t> geneLengths, textLengths;
+		string tmp = path + GROUP_CACHE_SUFFIX + ".tmp";
+		ofstream file;
+		size_t k;
+
+		memset(&h, 0, sizeof(h));
+		if (!getCacheKey(path, h, true))
+			return;
+		h.geneCount = genes.size();
+		for (k = 0; k < genes.size(); k++)
+		{
+			geneLengths.push_back(geneSymbols.getName(genes[k]).size());
+			h.geneBytes += geneLengths.back();
+		}
+		h.groupCount = groupIds.size();
+		for (k = 0; k < groupIds.size(); k++)
+		{
+			textLengths.push_back(groupSymbols.getName(groupIds[k]).size());
+			textLengths.push_back(groupSpe[k].size());
+			textLengths.push_back(groupSys[k].size());
+			textLengths.push_back(groupDesc[k].size());
+			h.textBytes += textLengths[4*k] + textLengths[4*k+1] + textLengths[4*k+2] + textLengths[4*k+3];
+		}
+		h.memberCount = members.size();
+
+		file.open(tmp.c_str(), ios::out | ios::binary | ios::trunc);
+		if (!file.is_open())
+		{
+			cout << "Could not write group cache " << tmp << endl;
+			return;
+		}
+		file.write((const char*)&h, sizeof(h));
+		file.write((const char*)geneLengths.data(), 4*geneLengths.size());
+		for (k = 0; k < genes.size(); k++)
+			file.write(geneSymbols.getName(genes[k]).data(), geneLengths[k]);
+		file.write("\0\0\0", GROUP_CACHE_PADDED(h.geneBytes) - h.geneBytes);
+		file.write((const char*)textLengths.data(), 4*textLengths.size());
+		for (k = 0; k < groupIds.size(); k++)
+		{
+			file.write(groupSymbols.getName(groupIds[k]).data(), textLengths[4*k]);
+			file.write(groupSpe[k].data(), groupSpe[k].size());
+			file.write(groupSys[k].data(), groupSys[k].size());
+			file.write(groupDesc[k].data(), groupDesc[k].size());
+		}
+		file.write("\0\0\0", GROUP_CACHE_PADDED(h.textBytes) - h.textBytes);
+		file.write((const char*)offsets.data(), 4*offsets.size());
+		file.write((const char*)members.data(), 4*members.size());
+		file.close();
+		//a cache is only ever seen whole
+		if (file.fail() || rename(tmp.c_str(), (path + GROUP_CACHE_SUFFIX).c_str()))
+		{
+			cout << "Could not write group cache " << path + GROUP_CACHE_SUFFIX << endl;
+			remove(tmp.c_str());
+		}
+	}
+
+	//used while reading a file
+	vector<int> geneIndex;	//gene symbol -> index in genes
+	vector<int> groupIndex;	//group symbol -> index in groupIds
+	vector<pair<uint32_t, uint32_t> > pairs;	//(group, gene) in file order
+};
+
+#endif
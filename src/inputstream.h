@@ -0,0 +1,420 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the InputStream class, a sequential reader of an input
+file that may be gzip or zstd compressed. The compression is detected from
+the magic bytes of the file. A reader thread reads and decompresses the file
+into blocks of INPUT_BLOCK_BYTES that it hands to the parser through a short
+queue, so decompression runs while the parser tokenizes the blocks before.
+zstd support is only built in if HAVE_ZSTD is 1.
+
+*/
+
+#ifndef __INPUTSTREAM_H__
+#define __INPUTSTREAM_H__
+
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <zlib.h>
+#ifndef HAVE_ZSTD
+	#define HAVE_ZSTD	0
+#endif
+#if HAVE_ZSTD
+	#include <zstd.h>
+#endif
+
+#include "mappedfile.h"
+
+using namespace std;
+
+#define COMPRESSION_NONE		0
+#define COMPRESSION_GZIP		1
+#define COMPRESSION_ZSTD		2
+
+#define INPUT_BLOCK_BYTES		(1 << 20) //decompressed bytes handed to the parser at a time
+#define INPUT_QUEUE_BLOCKS		4 //blocks the reader thread may be ahead of the parser
+
+//detectCompression:
+//	Returns the COMPRESSION_ type of the file at path from its magic bytes,
+//	COMPRESSION_NONE if it is not compressed or can not be read.
+inline int detectCompression(const string &path)
+{
+	unsigned char magic[4];
+	size_t n = 0;
+	FILE *f = fopen(path.c_str(), "rb");
+
+	if (f)
+	{
+		n = fread(magic, 1, sizeof(magic), f);
+		fclose(f);
+	}
+	if (n >= 2 && magic[0] == 0x1F && magic[1] == 0x8B)
+		return COMPRESSION_GZIP;
+	if (n >= 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD)
+		return COMPRESSION_ZSTD;
+	return COMPRESSION_NONE;
+}
+
+class InputStream
+{
+public:
+	InputStream(){file = NULL; compression = COMPRESSION_NONE; reset();}
+	~InputStream(){close();}
+
+	//open:
+	//	Opens the file at path and starts the reader thread. Returns false if it can not be opened.
+	//	Exits if the file is zstd compressed and zstd support was not built in.
+	bool open(const string &path)
+	{
+		close();
+		compression = detectCompression(path);
+#if !HAVE_ZSTD
+		if (compression == COMPRESSION_ZSTD)
+		{
+			cout << path << " is zstd compressed, but CrossTalkZ was built without zstd support." << endl;
+			exit(1);
+		}
+#endif
+		file = fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+		name = path;
+		reader = std::thread(&InputStream::readFile, this);
+		return true;
+	}
+
+	//stops the reader thread, blocks it has read ahead are dropped
+	void close()
+	{
+		if (reader.joinable())
+		{
+			{
+				lock_guard<mutex> lock(queueMutex);
+				stop = true;
+			}
+			queueChanged.notify_all();
+			reader.join();
+		}
+		if (file)
+			fclose(file);
+		file = NULL;
+		reset();
+	}
+
+	int getCompression() const
+	{
+		return compression;
+	}
+
+	//nextBlock:
+	//	Waits for the next block of the decompressed file and sets block to it. The block stays valid
+	//	until the next call. Returns false at the end of the file, exits if the file is corrupt.
+	bool nextBlock(TextSlice &block)
+	{
+		unique_lock<mutex> lock(queueMutex);
+
+		if (!current.empty())
+		{
+			spare.push_back(string());
+			spare.back().swap(current);
+		}
+		queueChanged.wait(lock, [this]{return !ready.empty() || done;});
+		if (ready.empty())
+		{
+			if (failed)
+			{
+				cout << "Error in decompressing " << name << endl;
+				exit(1);
+			}
+			pos = block = TextSlice();
+			return false;
+		}
+		current.swap(ready.front());
+		ready.pop_front();
+		queueChanged.notify_all();
+		block = pos = TextSlice(current.data(), current.data()+current.size());
+		return true;
+	}
+
+	//getline:
+	//	Reads the next line without its '\n' into line, like std::getline.
+	bool getline(string &line)
+	{
+		const char *eol;
+		bool got = false;
+
+		line.clear();
+		for (;;)
+		{
+			if (pos.empty() && !nextBlock(pos))
+				return got;
+			got = true;
+			eol = (const char*)memchr(pos.first, '\n', pos.size());
+			if (eol)
+			{
+				line.append(pos.first, eol);
+				pos.first = eol+1;
+				return true;
+			}
+			line.append(pos.first, pos.last);
+			pos.first = pos.last;
+		}
+	}
+
+	//read:
+	//	Copies up to len bytes to buf and returns their number, less than len only at the end of the file.
+	int read(char *buf, int len)
+	{
+		int n = 0, k;
+
+		while (n < len)
+		{
+			if (pos.empty() && !nextBlock(pos))
+				break;
+			k = (pos.size() < (size_t)(len-n)) ? (int)pos.size() : len-n;
+			memcpy(buf+n, pos.first, k);
+			pos.first += k;
+			n += k;
+		}
+		return n;
+	}
+
+protected:
+	InputStream(const InputStream&);
+	InputStream& operator=(const InputStream&);
+
+	void reset()
+	{
+		ready.clear();
+		spare.clear();
+		current.clear();
+		pos = TextSlice();
+		stop = done = failed = false;
+	}
+
+	//the reader thread
+	void readFile()
+	{
+		bool ok;
+
+		switch (compression)
+		{
+			case COMPRESSION_GZIP:
+				ok = inflateGzip();
+				break;
+#if HAVE_ZSTD
+			case COMPRESSION_ZSTD:
+				ok = inflateZstd();
+				break;
+#endif
+			default:
+				ok = copyFile();
+				break;
+		}
+		lock_guard<mutex> lock(queueMutex);
+		done = true;
+		failed = !ok;
+		queueChanged.notify_all();
+	}
+
+	//getBlock:
+	//	Waits until the queue has room and sets block to an empty INPUT_BLOCK_BYTES block.
+	//	Returns false if the stream is being closed.
+	bool getBlock(string &block)
+	{
+		unique_lock<mutex> lock(queueMutex);
+
+		queueChanged.wait(lock, [this]{return ready.size() < INPUT_QUEUE_BLOCKS || stop;});
+		if (stop)
+			return false;
+		if (!spare.empty())
+		{
+			block.swap(spare.back());
+			spare.pop_back();
+		}
+		block.resize(INPUT_BLOCK_BYTES);
+		return true;
+	}
+
+	//queues the first n bytes of block, empty blocks are not queued
+	void putBlock(string &block, size_t n)
+	{
+		if (!n)
+			return;
+		block.resize(n);
+		lock_guard<mutex> lock(queueMutex);
+		ready.push_back(string());
+		ready.back().swap(block);
+		queueChanged.notify_all();
+	}
+
+	bool copyFile()
+	{
+		string block;
+		size_t n;
+
+		do
+		{
+			if (!getBlock(block))
+				return true;
+			n = fread(&block[0], 1, block.size(), file);
+			putBlock(block, n);
+		} while (n == INPUT_BLOCK_BYTES);
+		return !ferror(file);
+	}
+
+	//inflateGzip:
+	//	Decompresses a gzip file, which may be several gzip members in a row.
+	//	Like gzip, trailing garbage after a complete member is ignored.
+	bool inflateGzip()
+	{
+		z_stream z;
+		string block;
+		vector<unsigned char> in(INPUT_BLOCK_BYTES);
+		bool eof = false, full = false, ended = false, ok = true;
+		int ret, members = 0;
+
+		memset(&z, 0, sizeof(z));
+		if (inflateInit2(&z, 15+32) != Z_OK || !getBlock(block))
+			return false;
+		z.next_out = (Bytef*)&block[0];
+		z.avail_out = block.size();
+		for (;;)
+		{
+			if (!z.avail_in && !eof)
+			{
+				z.avail_in = fread(&in[0], 1, in.size(), file);
+				z.next_in = &in[0];
+				eof = (z.avail_in == 0);
+			}
+			//at the end of the input inflate is only called again to flush output that did not fit
+			if (eof && (!full || ended))
+				break;
+			ret = inflate(&z, Z_NO_FLUSH);
+			full = (z.avail_out == 0);
+			if (ret == Z_STREAM_END)
+			{
+				members++;
+				ended = true;
+				inflateReset(&z);
+			}
+			else if (ret == Z_DATA_ERROR && members && ended)
+				break;
+			else if (ret != Z_OK && !(ret == Z_BUF_ERROR && full))
+			{
+				ok = false;
+				break;
+			}
+			else
+				ended = false;
+			if (full)
+			{
+				putBlock(block, block.size());
+				if (!getBlock(block))
+					break;
+				z.next_out = (Bytef*)&block[0];
+				z.avail_out = block.size();
+			}
+		}
+		if (ok && block.size())
+			putBlock(block, block.size()-z.avail_out);
+		inflateEnd(&z);
+		return ok && ended && !ferror(file);
+	}
+
+#if HAVE_ZSTD
+	//decompresses a zstd file, which may be several zstd frames in a row
+	bool inflateZstd()
+	{
+		ZSTD_DStream *zs = ZSTD_createDStream();
+		ZSTD_inBuffer zin;
+		ZSTD_outBuffer zout;
+		string block;
+		vector<char> in(ZSTD_DStreamInSize());
+		bool eof = false, full = false, ok = true;
+		size_t ret = 0;
+
+		if (!zs || ZSTD_isError(ZSTD_initDStream(zs)) || !getBlock(block))
+		{
+			ZSTD_freeDStream(zs);
+			return false;
+		}
+		zin.src = &in[0];
+		zin.size = zin.pos = 0;
+		zout.dst = &block[0];
+		zout.size = block.size();
+		zout.pos = 0;
+		for (;;)
+		{
+			if (zin.pos == zin.size && !eof)
+			{
+				zin.size = fread(&in[0], 1, in.size(), file);
+				zin.pos = 0;
+				eof = (zin.size == 0);
+			}
+			if (eof && !full)
+				break;
+			ret = ZSTD_decompressStream(zs, &zout, &zin);
+			if (ZSTD_isError(ret))
+			{
+				ok = false;
+				break;
+			}
+			full = (zout.pos == zout.size);
+			if (full)
+			{
+				putBlock(block, block.size());
+				if (!getBlock(block))
+					break;
+				zout.dst = &block[0];
+				zout.size = block.size();
+				zout.pos = 0;
+			}
+		}
+		if (ok && block.size())
+			putBlock(block, zout.pos);
+		ZSTD_freeDStream(zs);
+		return ok && ret == 0 && !ferror(file);
+	}
+#endif
+
+	FILE *file;
+	string name;
+	int compression;
+	std::thread reader;
+
+	//the queue between the reader thread and the parser, guarded by queueMutex
+	mutex queueMutex;
+	condition_variable queueChanged;
+	deque<string> ready; //read blocks in file order
+	vector<string> spare; //used blocks, their memory is reused
+	bool stop, done, failed;
+
+	//parser side
+	string current; //the block handed out last
+	TextSlice pos; //the unread part of current for getline and read
+};
+
+#endif
@@ -0,0 +1,240 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the LinkIndex class, an open addressing hash set of
+undirected links between dense node ids. A link is packed into one 64-bit
+key (smaller id in the high word) and looked up with linear probing, so
+testing, inserting and erasing a link are O(1) and touch one or two cache
+lines.
+It also contains the LinkMatrix class, an n x n bit matrix with the same
+interface for networks small enough that the matrix stays in cache, where
+a link test is a single bit test.
+
+*/
+
+#ifndef __LINKINDEX_H__
+#define __LINKINDEX_H__
+
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+#define LINK_INDEX_EMPTY	(~(uint64_t)0)	//never a valid key since no node id is 0xffffffff
+
+class LinkIndex
+{
+public:
+	typedef uint64_t Key;
+
+	LinkIndex(){clear();}
+	~LinkIndex(){}
+
+	static Key key(uint32_t v1, uint32_t v2)
+	{
+		if (v1 > v2)
+			return ((Key)v2 << 32) | v1;
+		return ((Key)v1 << 32) | v2;
+	}
+
+	//reserve:
+	//	Sizes the table for n links without rehashing. Removes all links.
+	void reserve(int n)
+	{
+		int bits = 4;
+		while ((1 << bits) < 2*n)
+			bits++;
+		slots.assign((size_t)1 << bits, LINK_INDEX_EMPTY);
+		mask = slots.size()-1;
+		shift = 64 - bits;
+		count = 0;
+	}
+
+	//removes all links but keeps the capacity of the table
+	void clear()
+	{
+		if (slots.empty())
+			reserve(0);
+		else
+		{
+			slots.assign(slots.size(), LINK_INDEX_EMPTY);
+			count = 0;
+		}
+	}
+
+	int size() const
+	{
+		return count;
+	}
+
+	bool contains(uint32_t v1, uint32_t v2) const
+	{
+		Key k = key(v1, v2);
+		for (size_t i = slot(k); slots[i] != LINK_INDEX_EMPTY; i = (i+1) & mask)
+			if (slots[i] == k)
+				return true;
+		return false;
+	}
+
+	//starts loading the slot of the link into the cache ahead of a contains, insert or erase
+	void prefetch(uint32_t v1, uint32_t v2) const
+	{
+		__builtin_prefetch(&slots[slot(key(v1, v2))]);
+	}
+
+	//returns false if the link was already in the index
+	bool insert(uint32_t v1, uint32_t v2)
+	{
+		Key k = key(v1, v2);
+		size_t i;
+
+		if (2*(count+1) > (int)slots.size())
+			grow();
+		for (i = slot(k); slots[i] != LINK_INDEX_EMPTY; i = (i+1) & mask)
+			if (slots[i] == k)
+				return false;
+		slots[i] = k;
+		count++;
+		return true;
+	}
+
+	//returns false if the link was not in the index
+	bool erase(uint32_t v1, uint32_t v2)
+	{
+		Key k = key(v1, v2);
+		size_t i, j, home;
+
+		for (i = slot(k); slots[i] != k; i = (i+1) & mask)
+			if (slots[i] == LINK_INDEX_EMPTY)
+				return false;
+
+		//backward shift deletion: pull later keys of the probe run into the hole
+		//so that lookups never need tombstones
+		for (j = (i+1) & mask; slots[j] != LINK_INDEX_EMPTY; j = (j+1) & mask)
+		{
+			home = slot(slots[j]);
+			if (((j - home) & mask) >= ((j - i) & mask))
+			{
+				slots[i] = slots[j];
+				i = j;
+			}
+		}
+		slots[i] = LINK_INDEX_EMPTY;
+		count--;
+		return true;
+	}
+
+protected:
+	size_t slot(Key k) const
+	{
+		return (size_t)((k * 0x9E3779B97F4A7C15ULL) >> shift);
+	}
+
+	void grow()
+	{
+		vector<Key> old;
+		old.swap(slots);
+		reserve(old.size());
+		for (size_t i = 0; i < old.size(); i++)
+			if (old[i] != LINK_INDEX_EMPTY)
+				insert((uint32_t)(old[i] >> 32), (uint32_t)old[i]);
+	}
+
+	vector<Key> slots;
+	size_t mask;
+	int shift;
+	int count;
+};
+
+class LinkMatrix
+{
+public:
+	LinkMatrix(){stride = 0; count = 0;}
+	~LinkMatrix(){}
+
+	//bytes needed for the matrix of a network with n nodes
+	static size_t bytes(int n)
+	{
+		return (size_t)n*((n+63)/64)*sizeof(uint64_t);
+	}
+
+	//reserve:
+	//	Sizes the matrix for n nodes. Removes all links.
+	void reserve(int n)
+	{
+		stride = (n+63)/64;
+		bits.assign((size_t)n*stride, 0);
+		count = 0;
+	}
+
+	void clear()
+	{
+		bits.assign(bits.size(), 0);
+		count = 0;
+	}
+
+	int size() const
+	{
+		return count;
+	}
+
+	bool contains(uint32_t v1, uint32_t v2) const
+	{
+		return (bits[(size_t)v1*stride + (v2 >> 6)] >> (v2 & 63)) & 1;
+	}
+
+	void prefetch(uint32_t v1, uint32_t v2) const
+	{
+		__builtin_prefetch(&bits[(size_t)v1*stride + (v2 >> 6)]);
+	}
+
+	//returns false if the link was already in the matrix
+	bool insert(uint32_t v1, uint32_t v2)
+	{
+		if (contains(v1, v2))
+			return false;
+		flip(v1, v2);
+		count++;
+		return true;
+	}
+
+	//returns false if the link was not in the matrix
+	bool erase(uint32_t v1, uint32_t v2)
+	{
+		if (!contains(v1, v2))
+			return false;
+		flip(v1, v2);
+		count--;
+		return true;
+	}
+
+protected:
+	//the matrix is kept symmetric, a link sets the bit in the rows of both nodes
+	void flip(uint32_t v1, uint32_t v2)
+	{
+		bits[(size_t)v1*stride + (v2 >> 6)] ^= (uint64_t)1 << (v2 & 63);
+		if (v1 != v2)
+			bits[(size_t)v2*stride + (v1 >> 6)] ^= (uint64_t)1 << (v1 & 63);
+	}
+
+	vector<uint64_t> bits;
+	size_t stride;	//64-bit words per row
+	int count;
+};
+
+#endif
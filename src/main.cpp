@@ -29,9 +29,12 @@ This file contains the entry point of CrossTalkZ.
 #include <algorithm>
 #include <iterator>
 #include <exception>
+#include <thread>
+#include <chrono>
 
 #include "crosstalkz.h"
 #include "boostgraphio.h"
+#include "randomnetworkwriter.h"
 
 using namespace std;
 using namespace boost;
@@ -47,6 +50,8 @@ string InfoFileFormat("crosstalkz_%s.info");
 
 bool userSpecifiedOutFile = false;
 bool writeRandomGraphOnly = false;
+int numRandomNetworks = 1; //networks written by -w
+unsigned int randomSeed; //the current time unless -S is given
 
 void parseArgs(int argc, char *argv[]);
 void printInfos(ostream &os);
@@ -55,114 +60,125 @@ void printInfos(ostream &os);
 /****************PROGRAM START****************/
 int main(int argc, char *argv[])
 {
-	srand(time(NULL));
+	randomSeed = time(NULL);
 
 	try {
 	
-		Graph origNetwork;
-		Graph randNetwork;
+		CSRGraph origSnapshot;
+		RandomGraph randNetwork;
 		BoostGraphIO bgio;
 		vector<GeneGroup> groups;
 		vector<GeneGroup> groups1, groups2;
-		map<string, vector<string> > geneToGroupMap;
-		map<string, vector<string> > geneToGroupMap1, geneToGroupMap2;
-		map<string, Stats > groupStatistics;
+		GeneGroupMap geneToGroupMap;
+		GeneGroupMap geneToGroupMap1, geneToGroupMap2;
+		vector<Stats> groupStatistics;
 		map<int, vector<Record> > degToRecordsMap;
 		stringstream infoString;
 		
 		parseArgs(argc, argv);
+		srand(randomSeed);
 	
-		bgio.setGraph(&origNetwork);
-		bgio.readGraph(NetworkFile);
+		if (!useNetworkCache || !bgio.readNetworkCache(NetworkFile, origSnapshot))
+		{
+			bgio.readNetwork(NetworkFile, origSnapshot); //everything after loading works on the snapshot
+			if (useNetworkCache)
+				bgio.writeNetworkCache(NetworkFile, origSnapshot);
+		}
 		
 		infoString << endl << "----NETWORK STATISTICS----" << endl;
-		infoString << "Final number of unique nodes in the network: " << origNetwork.getNodeCount() << endl;
-		infoString << "Final number of links in the network: " << origNetwork.getLinkCount() << endl;
+		infoString << "Final number of unique nodes in the network: " << origSnapshot.getNodeCount() << endl;
+		infoString << "Final number of links in the network: " << origSnapshot.getLinkCount() << endl;
 		
-		randNetwork = origNetwork; //dont need copy function yet, but must copy like this once and only once.	
-		generateMaps(origNetwork, randNetwork, degToRecordsMap);
-	
-		origNetwork.id = 0;
-		randNetwork.id = 1;
+		reorderNetwork(origSnapshot, orderFlag, infoString);
+		randNetwork.setMaxMatrixNodes(matrixMaxNodes);
+		randNetwork.init(origSnapshot);
+		generateMaps(origSnapshot, degToRecordsMap);
 		
 		if (writeRandomGraphOnly)
 		{
-			switch(methodFlag)
+			RandomNetworkWriter writer(bgio, origSnapshot);
+			RandomNetworkInfo info;
+			vector<float> weights;
+			vector<CSRGraph::NodeId> errors;
+			chrono::steady_clock::time_point iterStart;
+			
+			if (numRandomNetworks == 1)
+				cout << "\nWriting random graph to " << RandomGraphFile << endl;
+			else
+				cout << "\nWriting " << numRandomNetworks << " random graphs to " << RandomNetworkWriter::getNetworkPath(RandomGraphFile, 0, numRandomNetworks) << " ..." << endl;
+			writer.start(RandomGraphFile, numRandomNetworks);
+			
+			//the writer thread writes each network while the next one is randomized
+			for (int i = 0; i < numRandomNetworks; i++)
 			{
-				case METHOD_ASSIGN:
-				{
-					copyOrigToRand(origNetwork, randNetwork);
-					generateRandomNetworkAssignment(origNetwork, randNetwork);
-					break;
-				}
-				case METHOD_ASSIGN_SECOND:
-				{
-					copyOrigToRand(origNetwork, randNetwork);
-					generateRandomNetworkSecondOrder(origNetwork, randNetwork, degToRecordsMap);
-					break;
-				}
-				case METHOD_LABELSWAP:
+				//every network has its own seed, so that network i is randomized again by -S seed+i -N 1
+				info.index = i;
+				info.seed = randomSeed+i;
+				info.method = methodFlag;
+				info.conserved = true;
+				info.swapped = -1;
+				srand(info.seed);
+				iterStart = chrono::steady_clock::now();
+				switch(methodFlag)
 				{
-					generateRandomNetworkLabelSwap(origNetwork, randNetwork, degToRecordsMap);
-					break;
+					case METHOD_ASSIGN:
+					{
+						copyOrigToRand(origSnapshot, randNetwork);
+						info.conserved = generateRandomNetworkAssignment(origSnapshot, randNetwork);
+						break;
+					}
+					case METHOD_ASSIGN_SECOND:
+					{
+						copyOrigToRand(origSnapshot, randNetwork);
+						info.conserved = generateRandomNetworkSecondOrder(origSnapshot, randNetwork, degToRecordsMap);
+						break;
+					}
+					case METHOD_LABELSWAP:
+					{
+						randNetwork.resetLabels();
+						info.conserved = generateRandomNetworkLabelSwap(origSnapshot, randNetwork, degToRecordsMap);
+						break;
+					}
+					case METHOD_LINKSWAP:
+					{
+						copyOrigToRand(origSnapshot, randNetwork);
+						info.swapped = generateRandomNetworkLinkSwap(origSnapshot, randNetwork);
+						info.conserved = validateConnectivities(origSnapshot, randNetwork, errors);
+						break;
+					}	
+					default:
+						break;
 				}
-				case METHOD_LINKSWAP:
-				{
-					copyOrigToRand(origNetwork, randNetwork);
-					generateRandomNetworkLinkSwap(origNetwork, randNetwork);
-					break;
-				}	
-				default:
-					break;
+				info.seconds = chrono::duration<double>(chrono::steady_clock::now()-iterStart).count();
+				getRandomLinkWeights(origSnapshot, randNetwork, weights);
+				writer.write(info, randNetwork.getLinks(), weights);
 			}
-			cout << "\nWriting random graph to " << RandomGraphFile << endl;
-			bgio.setGraph(&randNetwork);
-			bgio.writeTSVGraph(RandomGraphFile);
+			writer.finish();
 			exit(0);
 		}
 	
 		if (allVsall)
 		{
 			infoString << endl << "----GROUP STATISTICS----" << endl;
-			readGeneGroups(origNetwork, groups, geneToGroupMap, GroupsFile, infoString);
+			readGeneGroups(origSnapshot, groups, geneToGroupMap, GroupsFile, infoString);
 			cout << infoString.str();
 		}
 		else
 		{
 			infoString << "----GROUP A STATISTICS----" << endl;
-			readGeneGroups(origNetwork, groups1, geneToGroupMap1, GroupsFile1, infoString);
+			readGeneGroups(origSnapshot, groups1, geneToGroupMap1, GroupsFile1, infoString);
 			infoString << "----GROUP B STATISTICS----" << endl;
-			readGeneGroups(origNetwork, groups2, geneToGroupMap2, GroupsFile2, infoString);
+			readGeneGroups(origSnapshot, groups2, geneToGroupMap2, GroupsFile2, infoString);
 			cout << endl <<  infoString.str();
 		}
 		
 		
-		if (origNetwork.getNodeCount() && (groups.size() || (groups1.size() && groups2.size())))
+		if (origSnapshot.getNodeCount() && (groups.size() || (groups1.size() && groups2.size())))
 		{		
-			string groupsVsStr;
 			clock_t iterStart, start = clock();
 			
+			//sized to the number of group pairs by the first call to countLinksForGroups*
 			groupStatistics.clear();
-			if (allVsall)
-			{		
-				for (int i = 0; i < (int)groups.size(); i++)
-					for (int j = 0; j <= i; j++)
-					{
-						groupsVsStr = groups[i].groupId + "_vs_" + groups[j].groupId;
-						groupStatistics[groupsVsStr].linkCount.clear();
-						groupStatistics[groupsVsStr].clusteringCoeff.clear();
-					}
-			}
-			else
-			{
-				for (int i = 0; i < (int)groups1.size(); i++)
-					for (int j = 0; j < (int)groups2.size(); j++)
-					{
-						groupsVsStr = groups1[i].groupId + "_vs_" +  groups2[j].groupId;
-						groupStatistics[groupsVsStr].linkCount.clear();
-						groupStatistics[groupsVsStr].clusteringCoeff.clear();
-					}
-			}
 				
 			for (int i = 0; i < numSimIter; i++)
 			{
@@ -173,30 +189,30 @@ int main(int argc, char *argv[])
 				{
 					case METHOD_ASSIGN:
 					{
-						if (!generateRandomNetworkAssignment(origNetwork, randNetwork))
-							copyOrigToRand(origNetwork, randNetwork);
+						if (!generateRandomNetworkAssignment(origSnapshot, randNetwork))
+							copyOrigToRand(origSnapshot, randNetwork);
 						else
 							printf("Randomized %d links between %d nodes in %f seconds.\n", randNetwork.getLinkCount(), randNetwork.getNodeCount(), (clock()-iterStart)/(CLOCKS_PER_SEC+0.0)); 
 						break;
 					}
 					case METHOD_ASSIGN_SECOND:
 					{
-						if (!generateRandomNetworkSecondOrder(origNetwork, randNetwork, degToRecordsMap))
-							copyOrigToRand(origNetwork, randNetwork);
+						if (!generateRandomNetworkSecondOrder(origSnapshot, randNetwork, degToRecordsMap))
+							copyOrigToRand(origSnapshot, randNetwork);
 						else
 							printf("Randomized %d links between %d nodes in %f seconds.\n", randNetwork.getLinkCount(), randNetwork.getNodeCount(), (clock()-iterStart)/(CLOCKS_PER_SEC+0.0)); 
 						break;
 					}
 					case METHOD_LABELSWAP:
 					{
-						generateRandomNetworkLabelSwap(origNetwork, randNetwork, degToRecordsMap);
+						generateRandomNetworkLabelSwap(origSnapshot, randNetwork, degToRecordsMap);
 						printf("Randomized labels for %d nodes in %f seconds.\n", randNetwork.getNodeCount(), (clock()-iterStart)/(CLOCKS_PER_SEC+0.0)); 
 						break;
 					}
 					case METHOD_LINKSWAP:
 					{
-						copyOrigToRand(origNetwork, randNetwork);
-						int swapped = generateRandomNetworkLinkSwap(origNetwork, randNetwork);
+						copyOrigToRand(origSnapshot, randNetwork);
+						int swapped = generateRandomNetworkLinkSwap(origSnapshot, randNetwork);
 						printf("Swapped %d of %d links between %d nodes in %f seconds.\n", swapped, randNetwork.getLinkCount(), randNetwork.getNodeCount(), (clock()-iterStart)/(CLOCKS_PER_SEC+0.0)); 
 						break;
 					}
@@ -207,9 +223,9 @@ int main(int argc, char *argv[])
 				
 	
 				if (allVsall)
-					countLinksForGroupsAll(randNetwork, groups, groupStatistics, geneToGroupMap);
+					countLinksForGroupsAll(origSnapshot, randNetwork.getLinks(), groups, groupStatistics, geneToGroupMap);
 				else
-					countLinksForGroups12(randNetwork, groups1, groups2, groupStatistics, geneToGroupMap1, geneToGroupMap2);	
+					countLinksForGroups12(origSnapshot, randNetwork.getLinks(), groups1, groups2, groupStatistics, geneToGroupMap1, geneToGroupMap2);	
 			}
 			cout << "\nFinished in " << (clock()-start+0.0)/CLOCKS_PER_SEC << " seconds." <<endl;
 	
@@ -233,9 +249,9 @@ int main(int argc, char *argv[])
 			}
 			
 			if (allVsall)
-				calculateAndWriteResultsAll(origNetwork, groups, groupStatistics, geneToGroupMap, AnalysisResultsFile);
+				calculateAndWriteResultsAll(origSnapshot, groups, groupStatistics, geneToGroupMap, AnalysisResultsFile);
 			else
-				calculateAndWriteResults12(origNetwork, groups1, groups2, groupStatistics, geneToGroupMap1, geneToGroupMap2, AnalysisResultsFile);
+				calculateAndWriteResults12(origSnapshot, groups1, groups2, groupStatistics, geneToGroupMap1, geneToGroupMap2, AnalysisResultsFile);
 			
 			if (userSpecifiedOutFile)
 			{
@@ -261,7 +277,7 @@ int main(int argc, char *argv[])
 		} //end if network has valid nodes and groups
 		else
 		{
-			if (!origNetwork.getNodeCount())
+			if (!origSnapshot.getNodeCount())
 				cout << "Network did not contain any vertices." << endl;
 			else
 				cout << "No valid groups." << endl; 
@@ -292,13 +308,17 @@ void parseArgs(int argc, char *argv[])
 			("help,h", "Produces this message.")
 			("network,n", value< string >(&NetworkFile), 
 				  "Path to a network file. Required.")
-			("group,g", value< string >(&GroupsFile), "Path to a group file. Results are comparisons between all possible\ngroup pair combinations within this file.")
+			("group,g", value< string >(&GroupsFile), "Path to a group file. Results are comparisons between all possible\ngroup pair combinations within this file.\nFiles named *.gmt are read as GMT, one group per line.")
 			("groupA,a", value< string >(&GroupsFile1), "Path to a group file. Results are comparisons between all possible\ngroup pair combinations between groupA and groupB. Requires groupB file.")
 			("groupB,b", value< string >(&GroupsFile2), "Path to a group file. Results are comparisons between all possible\ngroup pair combinations between groupA and groupB. Requires groupA file.")
+			("columns,C", value<string>(&networkColumns),
+				  "Columns of a TSV network to read, gene1,gene2[,score], each the 1 based column number\nor the column name in the header line. Lines starting with '#' are skipped.\nIf not specified, a simple or FunCoup TSV network is expected.")
 			("cutoff,c", value<float>(&cutoffScore), 
 				  "Lowest link weight to include in network. If not specified, all links are included.")
 			("method,d", value<int>(&methodFlag)->default_value(methodFlag),
 				  "Method 0: Link Permutation, swap links between nodes.\nMethod 1: Link Assignment, assign links uniformly randomly, conserve degree.\nMethod 2: Link Assignment + Second-order, same as 1 but attempt to conserve second-order properties also.\nMethod 3: Node Permutation, swap node labels only.")
+			("order,r", value<int>(&orderFlag)->default_value(orderFlag),
+				  "Order 0: keep nodes in file order.\nOrder 1: renumber nodes by decreasing degree.\nOrder 2: renumber nodes in reverse Cuthill-McKee order.")
 			("iter,i", value<int>(&numSimIter)->default_value(numSimIter),
 				  "Number of network randomizations.")
 			("mode,m", value<int>(&modeFlag)->default_value(modeFlag),
@@ -306,9 +326,23 @@ void parseArgs(int argc, char *argv[])
 			("outputFile,o", value< string > (&ResultFileFormat), "User specified results file.")
 			("phyper,p", value<bool>(&doHyper)->default_value(doHyper),
 				  "Also calculate and write out the hypergeometric probaility of the overlap\nbetween each group pair for gene set enrichment analysis.")
-			("writeGraph,w", value< string > (&RandomGraphFile), "Randomize original graph once and output graph to specified file.")
+			("writeGraph,w", value< string > (&RandomGraphFile), "Randomize the network -N times from one load and write the random networks to the\nspecified file, network i (from 0) randomized with seed -S plus i, as XGMML if the name ends in\n.xgmml or .xml and as TSV otherwise. Links kept from the network keep their weight,\nnew links have weight 1.")
+			("writeCount,N", value<int>(&numRandomNetworks)->default_value(numRandomNetworks),
+				  "Number of randomized graphs written by -w. More than one are written to the -w file name\nnumbered before its extension. The seed and statistics of every graph go to <file>.meta.")
+			("seed,S", value<unsigned int>(&randomSeed),
+				  "Seed of the random number generator. If not specified, the current time is used.")
 			("minGenes,x", value<int>(&minimumGenesForGroup)->default_value(minimumGenesForGroup),
 				  "Set the lower bound on the minimum number of genes a group should have to be included in the analysis.")
+			("switches,Q", value<double>(&switchesPerLink)->default_value(switchesPerLink),
+				  "Link switches attempted per link by the Link Permutation method (-d 0). More switches\nmix the network longer.")
+			("matrixNodes,M", value<int>(&matrixMaxNodes)->default_value(matrixMaxNodes),
+				  "Networks with at most this many nodes are randomized using a bit matrix for link tests\n(n*n/8 bytes of memory). 0 disables the bit matrix.")
+			("threads,t", value<int>(&numThreads)->default_value(numThreads),
+				  "Number of threads used to read the network and to count the genes groups share for -p.\n0 uses all cores.")
+			("cache,k", value<bool>(&useNetworkCache)->default_value(useNetworkCache),
+				  "Keep a binary copy of the loaded network next to the network file (network file" NETWORK_CACHE_SUFFIX ")\nand load it instead of the network file while neither the file nor the cutoff change.")
+			("groupCache,K", value<bool>(&useGroupCache)->default_value(useGroupCache),
+				  "Keep a binary copy of each parsed group file next to it (group file" GROUP_CACHE_SUFFIX ")\nand load it instead of the group file while the file does not change.")
 			
 			;
 
@@ -343,6 +377,9 @@ void parseArgs(int argc, char *argv[])
 		else
 			writeRandomGraphOnly = false;
 		
+		//the cutoff is applied as the network is read, only the written networks need the weights
+		keepLinkWeights = writeRandomGraphOnly;
+		
 		if (vm.count("group"))
 			allVsall = true;
 		else
@@ -367,6 +404,29 @@ void parseArgs(int argc, char *argv[])
 			exit(1);		
 		}
 		
+		if (numThreads <= 0)
+			numThreads = std::thread::hardware_concurrency();
+		if (numThreads <= 0)
+			numThreads = 1;
+		
+		if (orderFlag != ORDER_FILE && orderFlag != ORDER_DEGREE && orderFlag != ORDER_RCM)
+		{
+			cout << "Invalid Order: "<< orderFlag << endl;
+			exit(1);		
+		}
+		
+		if (switchesPerLink <= 0)
+		{
+			cout << "Invalid number of switches per link: "<< switchesPerLink << endl;
+			exit(1);
+		}
+		
+		if (numRandomNetworks < 1)
+		{
+			cout << "Invalid number of random graphs: "<< numRandomNetworks << endl;
+			exit(1);
+		}
+		
 		//cheap way to test if valid files
 		ifstream file(NetworkFile.c_str());
 		if (!file)
@@ -427,7 +487,14 @@ void printInfos(ostream &os)
 		os << "Result file:\t\t\t" << ResultFileFormat << endl;
 	
 	if (writeRandomGraphOnly)
+	{
 		os << "Random network file:\t\t" << RandomGraphFile << endl;
+		os << "Random networks:\t\t" << numRandomNetworks << endl;
+	}
+	os << "Random seed:\t\t\t" << randomSeed << endl;
+	
+	if (!networkColumns.empty())
+		os << "Network columns:\t\t" << networkColumns << endl;
 	
 	if (useCutoff)
 		os << "Link cutoff:\t\t\t" << cutoffScore << endl;
@@ -437,8 +504,15 @@ void printInfos(ostream &os)
 	os << "Iterations:\t\t\t" << numSimIter << endl;
 	os << "Link counting mode:\t\t" << modeFlag << endl;
 	os << "Randomization method:\t\t" << getMethodString(methodFlag) << endl;
+	if (methodFlag == METHOD_LINKSWAP)
+		os << "Switches per link:\t\t" << switchesPerLink << endl;
+	os << "Node order:\t\t\t" << getOrderString(orderFlag) << endl;
 	//os << "Also use clustering coeff:\t" << doClusteringCoeff << endl;
 	os << "Minimum genes for group:\t" << minimumGenesForGroup<< endl;
+	os << "Bit matrix up to nodes:\t\t" << matrixMaxNodes << endl;
+	os << "Threads:\t\t\t" << numThreads << endl;
+	os << "Network cache:\t\t\t" << (useNetworkCache ? "on" : "off") << endl;
+	os << "Group cache:\t\t\t" << (useGroupCache ? "on" : "off") << endl;
 	
 	os << endl;
 }
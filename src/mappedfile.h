@@ -0,0 +1,176 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the MappedFile class, a read only memory mapping of a
+whole input file, and the TextSlice helpers the network parsers use to walk
+the mapped bytes line by line and field by field without copying them into
+strings, and hashBytes, the content hash that validates cached networks.
+
+*/
+
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+class MappedFile
+{
+public:
+	MappedFile(){bytes = NULL; length = 0;}
+	~MappedFile(){close();}
+
+	//open:
+	//	Maps the file at path. Returns false if it can not be opened or mapped.
+	//	An empty file maps to size() 0.
+	bool open(const string &path)
+	{
+		struct stat st;
+		int fd;
+
+		close();
+		fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		if (fstat(fd, &st) < 0)
+		{
+			::close(fd);
+			return false;
+		}
+		length = st.st_size;
+		if (length)
+		{
+			void *p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED)
+			{
+				::close(fd);
+				length = 0;
+				return false;
+			}
+			bytes = (const char*)p;
+			madvise(p, length, MADV_SEQUENTIAL);
+		}
+		::close(fd);
+		return true;
+	}
+
+	void close()
+	{
+		if (bytes)
+			munmap((void*)bytes, length);
+		bytes = NULL;
+		length = 0;
+	}
+
+	const char* begin() const
+	{
+		return bytes;
+	}
+
+	const char* end() const
+	{
+		return bytes+length;
+	}
+
+	size_t size() const
+	{
+		return length;
+	}
+
+protected:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const char *bytes;
+	size_t length;
+};
+
+//a [first, last) range of bytes in a mapped file
+struct TextSlice
+{
+	TextSlice(){first = last = NULL;}
+	TextSlice(const char *f, const char *l){first = f; last = l;}
+
+	size_t size() const {return last-first;}
+	bool empty() const {return first == last;}
+
+	const char *first;
+	const char *last;
+};
+
+//nextLine:
+//	Sets line to the line starting at p without its '\n' and returns the start of the next line.
+inline const char* nextLine(const char *p, const char *end, TextSlice &line)
+{
+	const char *eol = (const char*)memchr(p, '\n', end-p);
+	if (!eol)
+		eol = end;
+	line = TextSlice(p, eol);
+	return (eol == end) ? end : eol+1;
+}
+
+//trims the trailing whitespace (" \n\r\t") of s
+inline TextSlice trimRight(TextSlice s)
+{
+	while (s.last != s.first && (s.last[-1] == ' ' || s.last[-1] == '\n' || s.last[-1] == '\r' || s.last[-1] == '\t'))
+		s.last--;
+	return s;
+}
+
+//atof of a slice, the slice need not be terminated
+inline float sliceToFloat(const TextSlice &s)
+{
+	char buf[64];
+	size_t n = s.size() < sizeof(buf)-1 ? s.size() : sizeof(buf)-1;
+	memcpy(buf, s.first, n);
+	buf[n] = '\0';
+	return atof(buf);
+}
+
+//hashBytes:
+//	A 64-bit hash of the n bytes at p, eight bytes per step, used to tell whether a file changed.
+inline uint64_t hashBytes(const char *p, size_t n)
+{
+	uint64_t h = 0x9E3779B97F4A7C15ULL ^ n, w;
+	size_t k;
+
+	for (k = 0; k+8 <= n; k += 8)
+	{
+		memcpy(&w, p+k, 8);
+		w *= 0xBF58476D1CE4E5B9ULL;
+		w ^= w >> 31;
+		h = (h ^ w) * 0x94D049BB133111EBULL;
+	}
+	for (; k < n; k++)
+		h = (h ^ (unsigned char)p[k]) * 0x100000001B3ULL;
+
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	return h;
+}
+
+#endif
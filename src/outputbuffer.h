@@ -0,0 +1,165 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the OutputBuffer class that the network writers use. It
+collects the output in a buffer of OUTPUT_BUFFER_BYTES and writes it to the
+file a whole buffer at a time, formatting numbers with to_chars and escaping
+XML text in place, so writing a line costs no system call and no stream
+formatting.
+
+*/
+
+#ifndef __OUTPUTBUFFER_H__
+#define __OUTPUTBUFFER_H__
+
+#include <stdio.h>
+#include <string.h>
+#include <charconv>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define OUTPUT_BUFFER_BYTES		(1 << 20)
+
+class OutputBuffer
+{
+public:
+	OutputBuffer(){file = NULL; used = 0; failed = false;}
+	~OutputBuffer(){close();}
+
+	//opens path for writing, returns false if it can not be created
+	bool open(const string &path)
+	{
+		close();
+		file = fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+		setvbuf(file, NULL, _IONBF, 0); //the buffer here is the only one
+		buffer.resize(OUTPUT_BUFFER_BYTES);
+		used = 0;
+		failed = false;
+		return true;
+	}
+
+	//close:
+	//	Writes out what is left in the buffer and closes the file.
+	//	Returns false if any write to the file failed.
+	bool close()
+	{
+		bool ok;
+
+		if (!file)
+			return !failed;
+		flush();
+		ok = (fclose(file) == 0) && !failed;
+		file = NULL;
+		return ok;
+	}
+
+	void put(char c)
+	{
+		if (used == buffer.size())
+			flush();
+		buffer[used++] = c;
+	}
+
+	void put(const char *s, size_t n)
+	{
+		if (n > buffer.size()-used)
+		{
+			flush();
+			if (n > buffer.size())
+			{
+				write(s, n);
+				return;
+			}
+		}
+		memcpy(&buffer[used], s, n);
+		used += n;
+	}
+
+	void put(const char *s)
+	{
+		put(s, strlen(s));
+	}
+
+	void put(const string &s)
+	{
+		put(s.data(), s.size());
+	}
+
+	void putInt(long long x)
+	{
+		char digits[24];
+		put(digits, to_chars(digits, digits+sizeof(digits), x).ptr-digits);
+	}
+
+	//the shortest decimal that reads back as x
+	void putFloat(float x)
+	{
+		char digits[32];
+		put(digits, to_chars(digits, digits+sizeof(digits), x).ptr-digits);
+	}
+
+	//s with the XML special characters escaped, for attribute values
+	void putXML(const string &s)
+	{
+		size_t k, from = 0;
+
+		for (k = 0; k < s.size(); k++)
+		{
+			const char *entity;
+			switch (s[k])
+			{
+				case '&': entity = "&amp;"; break;
+				case '<': entity = "&lt;"; break;
+				case '>': entity = "&gt;"; break;
+				case '"': entity = "&quot;"; break;
+				default: continue;
+			}
+			put(s.data()+from, k-from);
+			put(entity);
+			from = k+1;
+		}
+		put(s.data()+from, k-from);
+	}
+
+protected:
+	OutputBuffer(const OutputBuffer&);
+	OutputBuffer& operator=(const OutputBuffer&);
+
+	void flush()
+	{
+		write(&buffer[0], used);
+		used = 0;
+	}
+
+	void write(const char *s, size_t n)
+	{
+		if (n && fwrite(s, 1, n, file) != n)
+			failed = true;
+	}
+
+	FILE *file;
+	vector<char> buffer;
+	size_t used;
+	bool failed;
+};
+
+#endif
@@ -0,0 +1,233 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the RandomGraph class, the network that the randomization
+methods produce. It is a flat list of links between the node ids of the
+CSRGraph snapshot of the original network, with the degree of every node and
+an index of the links (a LinkIndex hash set, or a LinkMatrix for networks with
+at most maxMatrixNodes nodes) kept in step with the list for the hasLink tests
+of the randomizers. The counting routines read the link list directly.
+
+*/
+
+#ifndef __RANDOMGRAPH_H__
+#define __RANDOMGRAPH_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "csrgraph.h"
+#include "linkindex.h"
+
+using namespace std;
+
+//links as pairs of CSRGraph node ids
+typedef vector<pair<CSRGraph::NodeId, CSRGraph::NodeId> > LinkList;
+
+class RandomGraph
+{
+public:
+	typedef CSRGraph::NodeId NodeId;
+
+	RandomGraph(){maxMatrixNodes = 0; useMatrix = false;}
+	~RandomGraph(){}
+
+	//networks with at most n nodes are indexed with a LinkMatrix, takes effect on the next init
+	void setMaxMatrixNodes(int n)
+	{
+		maxMatrixNodes = n;
+	}
+
+	//init:
+	//	Sizes the graph for the nodes of g and copies the links of g.
+	void init(const CSRGraph &g)
+	{
+		labels.resize(g.getNodeCount());
+		resetLabels();
+
+		useMatrix = (g.getNodeCount() <= maxMatrixNodes);
+		if (useMatrix)
+		{
+			matrix.reserve(g.getNodeCount());
+			index = LinkIndex();
+		}
+		else
+		{
+			index.reserve(g.getLinkCount());
+			matrix = LinkMatrix();
+		}
+		links.reserve(g.getLinkCount());
+		copyLinks(g);
+	}
+
+	//copyLinks:
+	//	Replaces the links with the links of g, in g's node order.
+	void copyLinks(const CSRGraph &g)
+	{
+		CSRGraph::adjacency_node_range_t avr;
+
+		clearLinks();
+		for (NodeId v1 = 0; v1 < (NodeId)g.getNodeCount(); v1++)
+			for (avr = g.getLinkNeighbors(v1); avr.first != avr.second; avr.first++)
+				addLink(v1, *avr.first);
+	}
+
+	/* structure modification methods, these keep the degrees and the link index up to date */
+	void clearLinks()
+	{
+		links.clear();
+		degrees.assign(labels.size(), 0);
+		if (useMatrix)
+			matrix.clear();
+		else
+			index.clear();
+	}
+
+	void addLink(NodeId v1, NodeId v2)
+	{
+		links.push_back(pair<NodeId, NodeId>(v1, v2));
+		degrees[v1]++;
+		degrees[v2]++;
+		if (useMatrix)
+			matrix.insert(v1, v2);
+		else
+			index.insert(v1, v2);
+	}
+
+	//replaces link k with a link between v1 and v2
+	void setLink(int k, NodeId v1, NodeId v2)
+	{
+		degrees[links[k].first]--;
+		degrees[links[k].second]--;
+		if (useMatrix)
+			matrix.erase(links[k].first, links[k].second);
+		else
+			index.erase(links[k].first, links[k].second);
+		links[k] = pair<NodeId, NodeId>(v1, v2);
+		degrees[v1]++;
+		degrees[v2]++;
+		if (useMatrix)
+			matrix.insert(v1, v2);
+		else
+			index.insert(v1, v2);
+	}
+
+	//switchLinks:
+	//	Replaces links k1 (a, b) and k2 (c, d) with (a, d) and (c, b), or with (a, c) and (d, b) if turn.
+	//	The degrees do not change. The caller makes sure neither new link exists.
+	void switchLinks(int k1, int k2, bool turn)
+	{
+		NodeId a = links[k1].first, b = links[k1].second, c = links[k2].first, d = links[k2].second;
+
+		if (turn)
+			std::swap(c, d);
+		if (useMatrix)
+		{
+			matrix.erase(a, b);
+			matrix.erase(d, c);
+			matrix.insert(a, d);
+			matrix.insert(c, b);
+		}
+		else
+		{
+			index.erase(a, b);
+			index.erase(d, c);
+			index.insert(a, d);
+			index.insert(c, b);
+		}
+		links[k1].second = d;
+		links[k2] = pair<NodeId, NodeId>(c, b);
+	}
+
+	/* selectors and properties */
+	bool hasLink(NodeId v1, NodeId v2) const
+	{
+		if (useMatrix)
+			return matrix.contains(v1, v2);
+		return index.contains(v1, v2);
+	}
+
+	int getNodeCount() const
+	{
+		return (int)labels.size();
+	}
+
+	int getLinkCount() const
+	{
+		return (int)links.size();
+	}
+
+	int getNodeDegree(NodeId v) const
+	{
+		return degrees[v];
+	}
+
+	void getNodesByLink(int k, NodeId &v1, NodeId &v2) const
+	{
+		v1 = links[k].first;
+		v2 = links[k].second;
+	}
+
+	const LinkList& getLinks() const
+	{
+		return links;
+	}
+
+	//start loading link k, or the index entry of the link between v1 and v2, into the cache
+	void prefetchLink(int k) const
+	{
+		__builtin_prefetch(&links[k]);
+	}
+
+	void prefetchIndex(NodeId v1, NodeId v2) const
+	{
+		if (useMatrix)
+			matrix.prefetch(v1, v2);
+		else
+			index.prefetch(v1, v2);
+	}
+
+	//labels[v] is the node whose gene node v currently carries, permuted by the label swap method
+	vector<NodeId>& getLabels()
+	{
+		return labels;
+	}
+
+	const vector<NodeId>& getLabels() const
+	{
+		return labels;
+	}
+
+	//every node carries its own gene again
+	void resetLabels()
+	{
+		for (NodeId v = 0; v < (NodeId)labels.size(); v++)
+			labels[v] = v;
+	}
+
+protected:
+	LinkList links;
+	vector<uint32_t> degrees;
+	vector<NodeId> labels;
+	LinkIndex index;
+	LinkMatrix matrix;
+	int maxMatrixNodes;
+	bool useMatrix;
+};
+
+#endif
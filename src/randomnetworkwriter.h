@@ -0,0 +1,177 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the RandomNetworkWriter class that writes an ensemble of
+randomized networks for -w. The networks are written by a writer thread, one
+file per network, while the next one is randomized. A metadata file,
+<path>.meta, gets one line per written network with its file, the seed that
+reproduces it, the randomization method and what the method did.
+
+*/
+
+#ifndef __RANDOMNETWORKWRITER_H__
+#define __RANDOMNETWORKWRITER_H__
+
+#include <stdio.h>
+#include <fstream>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "crosstalkz.h"
+#include "boostgraphio.h"
+
+using namespace std;
+
+#define RANDOM_WRITER_QUEUE	2 //randomized networks waiting to be written at most
+
+//what one randomization did
+struct RandomNetworkInfo
+{
+	int index;	//0 based
+	unsigned int seed;	//srand seed the network was randomized with
+	int method;	//METHOD_
+	bool conserved;	//false if the method could not conserve the node degrees
+	int swapped;	//links swapped by METHOD_LINKSWAP, -1 for the other methods
+	double seconds;	//randomization time
+};
+
+//a network waiting to be written
+struct QueuedNetwork
+{
+	RandomNetworkInfo info;
+	LinkList links;
+	vector<float> weights;	//parallel to links, empty for weight 1
+};
+
+class RandomNetworkWriter
+{
+public:
+	RandomNetworkWriter(BoostGraphIO &io, const CSRGraph &nodes) : io(io), nodes(nodes){count = 0; stop = false;}
+	~RandomNetworkWriter(){finish();}
+
+	//getNetworkPath:
+	//	The file of network index out of count: path itself for a single network, else path
+	//	with the 1 based, zero padded index before its extension (rand.tsv -> rand_007.tsv).
+	static string getNetworkPath(const string &path, int index, int count)
+	{
+		char number[32];
+		size_t dot = path.find_last_of('.'), slash = path.find_last_of('/');
+
+		if (count == 1)
+			return path;
+		if (dot == string::npos || (slash != string::npos && dot < slash))
+			dot = path.size();
+		snprintf(number, sizeof(number), "_%0*d", (int)to_string(count).size(), index+1);
+		return path.substr(0, dot) + number + path.substr(dot);
+	}
+
+	//start:
+	//	Creates the metadata file of count networks written to path and starts the writer thread.
+	void start(const string &path, int count)
+	{
+		this->path = path;
+		this->count = count;
+		meta.open((path + ".meta").c_str());
+		if (!meta.is_open())
+		{
+			cout << "Error in opening " << path << ".meta" << endl;
+			exit(1);
+		}
+		meta << "network\tfile\tseed\tmethod\tnodes\tlinks\tconserved\tswapped\tseconds" << endl;
+		stop = false;
+		writer = std::thread(&RandomNetworkWriter::writeNetworks, this);
+	}
+
+	//write:
+	//	Queues a copy of links, with their weights (empty for weight 1), to be written as the network
+	//	described by info. Waits while RANDOM_WRITER_QUEUE networks are still queued, so randomizing
+	//	can not run far ahead of the disk.
+	void write(const RandomNetworkInfo &info, const LinkList &links, const vector<float> &weights)
+	{
+		unique_lock<mutex> lock(queueMutex);
+
+		queueChanged.wait(lock, [this]{return queue.size() < RANDOM_WRITER_QUEUE;});
+		queue.push_back(QueuedNetwork());
+		queue.back().info = info;
+		queue.back().links = links;
+		queue.back().weights = weights;
+		queueChanged.notify_all();
+	}
+
+	//waits until all queued networks are written and closes the metadata file
+	void finish()
+	{
+		if (writer.joinable())
+		{
+			{
+				lock_guard<mutex> lock(queueMutex);
+				stop = true;
+			}
+			queueChanged.notify_all();
+			writer.join();
+		}
+		if (meta.is_open())
+			meta.close();
+	}
+
+protected:
+	//the writer thread, writes the queued networks in order until finish is called
+	void writeNetworks()
+	{
+		QueuedNetwork next;
+		string file;
+
+		for (;;)
+		{
+			{
+				unique_lock<mutex> lock(queueMutex);
+				queueChanged.wait(lock, [this]{return !queue.empty() || stop;});
+				if (queue.empty())
+					return;
+				next.info = queue.front().info;
+				next.links.swap(queue.front().links);
+				next.weights.swap(queue.front().weights);
+				queue.pop_front();
+				queueChanged.notify_all();
+			}
+
+			file = getNetworkPath(path, next.info.index, count);
+			io.writeGraph(file, nodes, next.links, next.weights);
+			meta << next.info.index+1 << "\t" << file << "\t" << next.info.seed << "\t" << getMethodString(next.info.method)
+				<< "\t" << nodes.getNodeCount() << "\t" << next.links.size() << "\t" << (next.info.conserved ? 1 : 0)
+				<< "\t" << next.info.swapped << "\t" << next.info.seconds << "\n";
+		}
+	}
+
+	BoostGraphIO &io;
+	const CSRGraph &nodes;
+	string path;
+	int count;
+	ofstream meta;
+	std::thread writer;
+
+	mutex queueMutex;
+	condition_variable queueChanged;
+	deque<QueuedNetwork> queue;
+	bool stop;
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the SymbolTable class that interns identifier strings
+into dense integer symbols 0..N-1. Gene and group ids are interned once
+when they are parsed; afterwards the program works on the symbols and only
+turns them back into strings when results are written.
+
+*/
+
+#ifndef __SYMBOLTABLE_H__
+#define __SYMBOLTABLE_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
+using namespace std;
+
+class SymbolTable
+{
+public:
+	typedef uint32_t Symbol;
+	static const Symbol NONE = 0xffffffff;
+
+	SymbolTable(){}
+	~SymbolTable(){}
+
+	//returns the symbol of name, adding name to the table if it is new
+	Symbol intern(const string &name)
+	{
+		pair<boost::unordered_map<string, Symbol>::iterator, bool> ret;
+		ret = index.insert(pair<string, Symbol>(name, (Symbol)names.size()));
+		if (ret.second)
+			names.push_back(name);
+		return ret.first->second;
+	}
+
+	//intern of the n bytes at name, only allocates if the name is new
+	Symbol intern(const char *name, size_t n)
+	{
+		Bytes key(name, n);
+		boost::unordered_map<string, Symbol>::const_iterator it = index.find(key, BytesHash(), BytesEqual());
+		if (it != index.end())
+			return it->second;
+		return intern(string(name, n));
+	}
+
+	//returns the symbol of name or NONE if name was never interned
+	Symbol find(const string &name) const
+	{
+		boost::unordered_map<string, Symbol>::const_iterator it = index.find(name);
+		if (it == index.end())
+			return NONE;
+		return it->second;
+	}
+
+	const string& getName(Symbol s) const
+	{
+		return names[s];
+	}
+
+	int size() const
+	{
+		return (int)names.size();
+	}
+
+	void clear()
+	{
+		index.clear();
+		names.clear();
+	}
+
+protected:
+	//lookup key for a name that is not in a string, hashed the same way as the string keys
+	struct Bytes
+	{
+		Bytes(const char *p, size_t n) : ptr(p), len(n) {}
+		const char *ptr;
+		size_t len;
+	};
+	struct BytesHash
+	{
+		size_t operator()(const Bytes &b) const {return boost::hash_range(b.ptr, b.ptr+b.len);}
+	};
+	struct BytesEqual
+	{
+		bool operator()(const Bytes &b, const string &s) const {return s.size() == b.len && !memcmp(s.data(), b.ptr, b.len);}
+		bool operator()(const string &s, const Bytes &b) const {return (*this)(b, s);}
+	};
+
+	boost::unordered_map<string, Symbol> index;
+	vector<string> names;
+};
+
+//gene ids (network nodes and group members) and group ids of the current run
+extern SymbolTable geneSymbols;
+extern SymbolTable groupSymbols;
+
+#endif
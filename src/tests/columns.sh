@@ -0,0 +1,54 @@
+#columns.sh: -C reads the links of a wide table from the columns it names, by number or by
+#header name, separated by tabs or spaces, with or without a score, and gives the network
+#of the plain TSV file of those columns.
+
+. "$(dirname "$0")/common.sh"
+
+#randomize LOG OUT ARGS...: one label swap network with seed 7 in OUT
+randomize()
+{
+	log=$1
+	out=$2
+	shift 2
+	run "$log" -g "$KEGG" -d 3 -S 7 -k 0 -w "$out" "$@"
+}
+
+makeNetwork net.tsv
+randomize plain.log plain.tsv -n net.tsv
+randomize plaincut.log plaincut.tsv -n net.tsv -c 0.5
+cut -f1,2 net.tsv > unscored.tsv
+randomize plainunscored.log plainunscored.tsv -n unscored.tsv
+
+#the genes in the 5th and 4th of 6 columns, the score in the 2nd, with comment lines
+awk 'BEGIN {FS = OFS = "\t"; print "#id", "score", "source", "geneB", "geneA", "note"}
+	{print NR, $3, "db" NR % 3, $2, $1, "some text"}
+	NR % 100 == 0 {print "# a comment"}' net.tsv > wide.tsv
+
+randomize names.log names.tsv -n wide.tsv -C geneA,geneB,score
+same plain.tsv names.tsv
+randomize numbers.log numbers.tsv -n wide.tsv -C 5,4,2
+same plain.tsv numbers.tsv
+randomize cut.log cut.tsv -n wide.tsv -C geneA,geneB,score -c 0.5
+same plaincut.tsv cut.tsv
+randomize unscoredcolumns.log unscoredcolumns.tsv -n wide.tsv -C geneA,geneB
+same plainunscored.tsv unscoredcolumns.tsv
+
+#cells separated by spaces
+tr "\t" " " < wide.tsv > spaces.txt
+randomize spaces.log spaces.tsv -n spaces.txt -C "geneA, geneB, score"
+same plain.tsv spaces.tsv
+
+#the columns are part of the network cache key
+run cached.log -n wide.tsv -g "$KEGG" -C geneA,geneB,score -i 1 -k 1 -o cached.csv
+run other.log -n wide.tsv -g "$KEGG" -C geneB,geneA,score -i 1 -k 1 -o other.csv
+grep -q "Reading network from cache" other.log && fail "the cache of other columns was used"
+run again.log -n wide.tsv -g "$KEGG" -C geneB,geneA,score -i 1 -k 1 -o again.csv
+grep -q "Reading network from cache" again.log || fail "the cache of the same columns was not used"
+
+#columns that are not there
+"$BIN" -n wide.tsv -g "$KEGG" -C geneA,gene2 -k 0 -o bad.csv > bad.log 2>&1 && fail "an unknown column was accepted"
+grep -q "Network column gene2 not found" bad.log || fail "no message for an unknown column:" "$(cat bad.log)"
+"$BIN" -n wide.tsv -g "$KEGG" -C 5 -k 0 -o bad.csv > bad.log 2>&1 && fail "a single column was accepted"
+grep -q "Invalid network columns" bad.log || fail "no message for a single column:" "$(cat bad.log)"
+
+exit 0
@@ -0,0 +1,60 @@
+#common.sh: sourced by every test script, which is run as
+#	sh <test>.sh <CrossTalkZ binary> <data directory>
+#Runs the test in a scratch directory that is removed afterwards and provides
+#the helpers below.
+
+BIN=$1
+DATA=$2
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+#a copy, the group cache of -K is written next to the group file and not into the source tree
+KEGG=$WORK/KEGG_Human_hgnc.tsv
+cp "$DATA/KEGG_Human_hgnc.tsv" "$KEGG" || exit 1
+
+#fail MESSAGE: ends the test as failed
+fail()
+{
+	echo "FAIL: $*"
+	exit 1
+}
+
+#run LOG ARGS...: runs CrossTalkZ with ARGS, its output in LOG
+run()
+{
+	log=$1
+	shift
+	"$BIN" "$@" > "$log" 2>&1 || fail "CrossTalkZ $* exited with $?, see:" "$(cat "$log")"
+}
+
+#same FILE1 FILE2: fails unless both files are equal
+same()
+{
+	cmp -s "$1" "$2" || fail "$1 and $2 differ"
+}
+
+#makeNetwork FILE [LINKS [SEED]]: writes a scored TSV network of LINKS random links
+#between the genes of the KEGG groups, the same one for the same SEED
+makeNetwork()
+{
+	cut -f1 "$KEGG" | tr a-z A-Z | grep -v '^$\| ' | sort -u | awk -v links="${2:-4000}" -v x="${3:-1}" '
+		{genes[n++] = $1}
+		END {
+			for (k = 0; k < links; k++) {
+				x = (x*16807) % 2147483647; a = x % n
+				x = (x*16807) % 2147483647; b = x % n
+				x = (x*16807) % 2147483647
+				if (a != b)
+					printf "%s\t%s\t%.3f\n", genes[a], genes[b], (x % 1000)/1000
+			}
+		}' > "$1"
+}
+
+#damage FILE THIRD BYTE: overwrites a third of FILE, from THIRD thirds in, with bytes
+#of value BYTE (octal), keeping its size
+damage()
+{
+	size=$(wc -c < "$1")
+	head -c $((size/3)) /dev/zero | tr '\0' "\\$3" | dd of="$1" bs=1 seek=$((size*$2/3)) conv=notrunc 2> /dev/null
+	[ "$(wc -c < "$1")" = "$size" ] || fail "damaging $1 changed its size"
+}
@@ -0,0 +1,69 @@
+#compressed.sh: gzip and zstd compressed networks and group files, TSV and XGMML, give the
+#same results as the files they were compressed from, also through the network cache.
+#zstd is only tested if the zstd tool is installed; a binary without zstd support must
+#refuse zstd files.
+
+. "$(dirname "$0")/common.sh"
+
+#analyze LOG OUT ARGS...: the results of one randomization with seed 7 in OUT
+analyze()
+{
+	log=$1
+	out=$2
+	shift 2
+	run "$log" -S 7 -i 1 -o "$out" "$@"
+}
+
+makeNetwork net.tsv
+cp "$KEGG" groups.tsv
+analyze ref.log ref.csv -n net.tsv -g groups.tsv -k 0 -K 0
+
+gzip -c net.tsv > net.tsv.gz
+analyze gzip.log gzip.csv -n net.tsv.gz -g groups.tsv -k 0 -K 0
+same ref.csv gzip.csv
+
+#a file of several gzip members, as cat of gzip files makes
+head -n 1000 net.tsv | gzip -c > parts.tsv.gz
+tail -n +1001 net.tsv | gzip -c >> parts.tsv.gz
+analyze parts.log parts.csv -n parts.tsv.gz -g groups.tsv -k 0 -K 0
+same ref.csv parts.csv
+
+gzip -c groups.tsv > groups.tsv.gz
+analyze groups.log groups.csv -n net.tsv -g groups.tsv.gz -k 0 -K 0
+same ref.csv groups.csv
+
+#the caches of compressed files
+analyze write.log write.csv -n net.tsv.gz -g groups.tsv.gz -k 1 -K 1
+[ -e net.tsv.gz.ctzcache ] || fail "no network cache was written"
+[ -e groups.tsv.gz.ctzgroups ] || fail "no group cache was written"
+analyze read.log read.csv -n net.tsv.gz -g groups.tsv.gz -k 1 -K 1
+grep -q "Reading network from cache" read.log || fail "the network cache was not used"
+grep -q "Reading groups from cache" read.log || fail "the group cache was not used"
+same ref.csv write.csv
+same ref.csv read.csv
+
+#a randomized network written from a compressed file, and read back compressed
+run plain.log -n net.tsv -g groups.tsv -d 3 -S 7 -k 0 -K 0 -w plain.xgmml
+run packed.log -n net.tsv.gz -g groups.tsv -d 3 -S 7 -k 0 -K 0 -w packed.xgmml
+same plain.xgmml packed.xgmml
+gzip -c plain.xgmml > plain.xgmml.gz
+analyze xgmml.log xgmml.csv -n plain.xgmml -g groups.tsv -k 0 -K 0
+analyze xgmmlgzip.log xgmmlgzip.csv -n plain.xgmml.gz -g groups.tsv -k 0 -K 0
+same xgmml.csv xgmmlgzip.csv
+
+if command -v zstd > /dev/null
+then
+	zstd -q -c net.tsv > net.tsv.zst
+	"$BIN" -n net.tsv.zst -g groups.tsv -S 7 -i 1 -k 0 -K 0 -o zstd.csv > zstd.log 2>&1
+	if grep -q "built without zstd support" zstd.log
+	then
+		[ -e zstd.csv ] && fail "a zstd file was read without zstd support"
+	else
+		same ref.csv zstd.csv
+		zstd -q -c groups.tsv > groups.tsv.zst
+		analyze zstdgroups.log zstdgroups.csv -n net.tsv -g groups.tsv.zst -k 0 -K 0
+		same ref.csv zstdgroups.csv
+	fi
+fi
+
+exit 0
@@ -0,0 +1,90 @@
+#groupcache.sh: a group cache is used while its group file is unchanged, is controlled
+#by -K alone, and gives the same results as the group file.
+
+. "$(dirname "$0")/common.sh"
+
+#analyze LOG OUT ARGS...: the results of one randomization of net.tsv with seed 7 in OUT
+analyze()
+{
+	log=$1
+	out=$2
+	shift 2
+	run "$log" -n net.tsv -S 7 -i 1 -o "$out" "$@"
+}
+
+fromCache()
+{
+	grep -q "Reading groups from cache" "$1"
+}
+
+makeNetwork net.tsv
+cp "$KEGG" groups.tsv
+analyze ref.log ref.csv -g groups.tsv -K 0
+[ -e groups.tsv.ctzgroups ] && fail "-K 0 wrote a cache"
+
+analyze write.log write.csv -g groups.tsv -K 1
+fromCache write.log && fail "read a cache that did not exist"
+[ -e groups.tsv.ctzgroups ] || fail "-K 1 did not write a cache"
+same ref.csv write.csv
+
+analyze read.log read.csv -g groups.tsv -K 1
+fromCache read.log || fail "the cache was not used"
+same ref.csv read.csv
+
+#-k leaves the group cache alone
+analyze nonet.log nonet.csv -g groups.tsv -K 1 -k 0
+fromCache nonet.log || fail "-k 0 turned the group cache off"
+analyze nogroup.log nogroup.csv -g groups.tsv -K 0 -k 1
+fromCache nogroup.log && fail "-K 0 read the group cache"
+same ref.csv nogroup.csv
+
+#the same size and time but other groups, only the content hash tells;
+#swaps the groups of the first two genes
+cp -p groups.tsv orig.tsv
+awk 'BEGIN {FS = OFS = "\t"} NR == 1 {getline next_line; n = split(next_line, l, "\t"); t = $2; $2 = l[2]; l[2] = t; print; line = l[1]; for (k = 2; k <= n; k++) line = line OFS l[k]; print line; next} {print}' orig.tsv > groups.tsv
+cmp -s groups.tsv orig.tsv && fail "could not edit the groups"
+[ "$(wc -c < groups.tsv)" = "$(wc -c < orig.tsv)" ] || fail "the edited groups changed size"
+touch -r orig.tsv groups.tsv
+analyze edited.log edited.csv -g groups.tsv -K 1
+fromCache edited.log && fail "the cache of other content was used"
+analyze editedref.log editedref.csv -g groups.tsv -K 0
+same editedref.csv edited.csv
+
+#a damaged cache is ignored and rewritten
+head -c 200 groups.tsv.ctzgroups > cut.ctzgroups
+mv cut.ctzgroups groups.tsv.ctzgroups
+analyze damaged.log damaged.csv -g groups.tsv -K 1
+fromCache damaged.log && fail "a truncated cache was used"
+same editedref.csv damaged.csv
+
+#GMT files and the two group files of -a and -b are cached the same way
+awk 'BEGIN {FS = "\t"} {members[$2] = members[$2] "\t" $1} END {for (g in members) print g "\tdesc" members[g]}' orig.tsv | sort > groups.gmt
+analyze gmtref.log gmtref.csv -g groups.gmt -K 0
+analyze gmtwrite.log gmtwrite.csv -g groups.gmt -K 1
+analyze gmtread.log gmtread.csv -g groups.gmt -K 1
+fromCache gmtread.log || fail "the GMT cache was not used"
+same gmtref.csv gmtwrite.csv
+same gmtref.csv gmtread.csv
+
+analyze abref.log abref.csv -a orig.tsv -b groups.gmt -K 0
+analyze abwrite.log abwrite.csv -a orig.tsv -b groups.gmt -K 1
+analyze abread.log abread.csv -a orig.tsv -b groups.gmt -K 1
+[ "$(grep -c "Reading groups from cache" abread.log)" = 2 ] || fail "the caches of -a and -b were not both used"
+same abref.csv abwrite.csv
+same abref.csv abread.csv
+
+#a cache damaged in place keeps its size and key, its arrays must not be used
+for place in 0 1 2
+do
+	for byte in 377 200
+	do
+		analyze before$place$byte.log before.csv -g groups.gmt -K 1
+		fromCache before$place$byte.log || fail "the GMT cache was not used"
+		damage groups.gmt.ctzgroups $place $byte
+		analyze overwritten$place$byte.log overwritten.csv -g groups.gmt -K 1
+		fromCache overwritten$place$byte.log && fail "a cache overwritten at $place/3 with \\$byte was used"
+		same gmtref.csv overwritten.csv
+	done
+done
+
+exit 0
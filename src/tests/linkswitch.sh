@@ -0,0 +1,58 @@
+#linkswitch.sh: Link Permutation (-d 0) keeps the number of links and the degree of every
+#gene, also of genes linked to themselves, and never makes a link twice or a new link of a
+#gene to itself, mixes the network more with more switches per link (-Q), and refuses a
+#number of switches that is not positive.
+
+. "$(dirname "$0")/common.sh"
+
+#degrees NETWORK: "GENE<tab>DEGREE" of every gene of a TSV network, sorted, a link of a
+#gene to itself counted twice as the degree of the gene counts it
+degrees()
+{
+	awk 'BEGIN {FS = OFS = "\t"} {d[$1]++; d[$2]++} END {for (g in d) print g, d[g]}' "$1" | sort
+}
+
+#kept ORIGINAL RANDOM: the number of links of RANDOM that are links of ORIGINAL too
+kept()
+{
+	awk 'BEGIN {FS = "\t"} NR == FNR {link[$1 FS $2] = 1; link[$2 FS $1] = 1; next} ($1 FS $2) in link {n++} END {print n+0}' "$1" "$2"
+}
+
+#the genes of the network are kept unique, as the reader keeps them, and the first gene
+#of every 300th link is linked to itself too
+makeNetwork links.tsv 6000
+awk 'BEGIN {FS = "\t"} !(($1 FS $2) in seen) && !(($2 FS $1) in seen) {seen[$1 FS $2] = 1; print}
+	NR % 300 == 0 && !(($1 FS $1) in seen) {seen[$1 FS $1] = 1; print $1 FS $1 FS $3}' links.tsv > net.tsv
+awk 'BEGIN {FS = "\t"} $1 == $2 {n++} END {exit n < 10}' net.tsv || fail "net.tsv has too few links of a gene to itself"
+degrees net.tsv > want.txt
+links=$(wc -l < net.tsv)
+
+for q in 0.05 10
+do
+	run switch$q.log -n net.tsv -g "$KEGG" -d 0 -Q $q -S 7 -k 0 -w switch$q.tsv
+	degrees switch$q.tsv > got.txt
+	same want.txt got.txt
+	[ $(wc -l < switch$q.tsv) = $links ] || fail "-Q $q wrote $(wc -l < switch$q.tsv) links of $links"
+	awk 'BEGIN {FS = "\t"} NR == FNR {if ($1 == $2) self[$1] = 1; next}
+		$1 == $2 && !($1 in self) {print "a new link of " $1 " to itself"; exit 1}
+		($1 FS $2) in seen || ($2 FS $1) in seen {print "the link " $1 " " $2 " twice"; exit 1}
+		{seen[$1 FS $2] = 1}' net.tsv switch$q.tsv || fail "-Q $q wrote a wrong link"
+	awk 'BEGIN {FS = "\t"} NR == 2 {exit !($6 == '$links' && $7 == 1)}' switch$q.tsv.meta \
+		|| fail "-Q $q has the metadata" "$(cat switch$q.tsv.meta)"
+done
+
+#a switch replaces two links, so 0.05 switches per link change at most a tenth of
+#the links; 10 switches per link change most of them
+few=$(kept net.tsv switch0.05.tsv)
+many=$(kept net.tsv switch10.tsv)
+[ $few -ge $((links*9/10)) ] || fail "-Q 0.05 kept only $few of $links links"
+[ $few -lt $links ] || fail "-Q 0.05 switched no link"
+[ $many -lt $((links/5)) ] || fail "-Q 10 kept $many of $links links"
+
+for q in 0 -1
+do
+	"$BIN" -n net.tsv -g "$KEGG" -d 0 -Q $q -k 0 -w bad.tsv > bad.log 2>&1 && fail "-Q $q was accepted"
+	grep -q "Invalid number of switches per link" bad.log || fail "no message for -Q $q:" "$(cat bad.log)"
+done
+
+exit 0
@@ -0,0 +1,31 @@
+#modes.sh: the links counted between two overlapping groups by -m 0 and -m 1, which do
+#not depend on the order of the genes of a link or on the node order.
+#G1 = {A, B, C} and G2 = {B, C, D}. A-D joins them under both modes, B-C under neither
+#since both genes are in both groups, and A-B and C-D, each with one gene in both
+#groups, only under -m 1.
+
+. "$(dirname "$0")/common.sh"
+
+printf 'A\tG1\nB\tG1\nC\tG1\nB\tG2\nC\tG2\nD\tG2\n' > groups.tsv
+printf 'A\tB\nB\tC\nC\tD\nA\tD\n' > net.tsv
+printf 'B\tA\nC\tB\nD\tC\nD\tA\n' > reversed.tsv
+
+#observed LOG ARGS...: the observed links between G1 and G2
+observed()
+{
+	log=$1
+	shift
+	run "$log" -g groups.tsv -x 1 -i 2 -k 0 -K 0 -o "$log.csv" "$@"
+	grep "^G[12]_vs_G[12]	.*	inter	" "$log.csv" | cut -f4
+}
+
+for network in net.tsv reversed.tsv
+do
+	for order in 0 1 2
+	do
+		[ "$(observed m0.log -n $network -r $order -m 0)" = 1 ] || fail "-m 0 -r $order on $network did not count 1 link"
+		[ "$(observed m1.log -n $network -r $order -m 1)" = 3 ] || fail "-m 1 -r $order on $network did not count 3 links"
+	done
+done
+
+exit 0
@@ -0,0 +1,84 @@
+#networkcache.sh: a network cache is used while its network file and the cutoff are
+#unchanged, and a network loaded from its cache randomizes like the network file.
+
+. "$(dirname "$0")/common.sh"
+
+#randomize LOG OUT ARGS...: writes the random network of seed 7 of net.tsv to OUT
+randomize()
+{
+	log=$1
+	out=$2
+	shift 2
+	run "$log" -n net.tsv -g "$KEGG" -S 7 -w "$out" "$@"
+}
+
+fromCache()
+{
+	grep -q "Reading network from cache" "$1"
+}
+
+makeNetwork net.tsv
+randomize ref.log ref.tsv -k 0
+[ -e net.tsv.ctzcache ] && fail "-k 0 wrote a cache"
+
+randomize write.log write.tsv -k 1
+fromCache write.log && fail "read a cache that did not exist"
+[ -e net.tsv.ctzcache ] || fail "-k 1 did not write a cache"
+same ref.tsv write.tsv
+
+randomize read.log read.tsv -k 1
+fromCache read.log || fail "the cache was not used"
+same ref.tsv read.tsv
+
+#a cutoff keeps other links
+randomize cutoffref.log cutoffref.tsv -k 0 -c 0.5
+randomize cutoff.log cutoff.tsv -k 1 -c 0.5
+fromCache cutoff.log && fail "the cache was used for another cutoff"
+same cutoffref.tsv cutoff.tsv
+
+#the same size and time but other links, only the content hash tells
+randomize recache.log recache.tsv -k 1
+same ref.tsv recache.tsv
+cp -p net.tsv orig.tsv
+#swaps the second genes of the first two links
+awk 'BEGIN {FS = OFS = "\t"} NR == 1 {getline next_line; split(next_line, l, "\t"); t = $2; $2 = l[2]; l[2] = t; print; print l[1], l[2], l[3]; next} {print}' orig.tsv > net.tsv
+cmp -s net.tsv orig.tsv && fail "could not edit the network"
+[ "$(wc -c < net.tsv)" = "$(wc -c < orig.tsv)" ] || fail "the edited network changed size"
+touch -r orig.tsv net.tsv
+randomize edited.log edited.tsv -k 1
+fromCache edited.log && fail "the cache of other content was used"
+randomize editedref.log editedref.tsv -k 0
+same editedref.tsv edited.tsv
+
+#a grown file
+makeNetwork net.tsv 4500
+randomize grownref.log grownref.tsv -k 0
+randomize grown.log grown.tsv -k 1
+fromCache grown.log && fail "the cache of a smaller file was used"
+same grownref.tsv grown.tsv
+
+#a damaged cache is ignored and rewritten
+head -c 200 net.tsv.ctzcache > cut.ctzcache
+mv cut.ctzcache net.tsv.ctzcache
+randomize damaged.log damaged.tsv -k 1
+fromCache damaged.log && fail "a truncated cache was used"
+same grownref.tsv damaged.tsv
+randomize again.log again.tsv -k 1
+fromCache again.log || fail "the truncated cache was not rewritten"
+same grownref.tsv again.tsv
+
+#a cache damaged in place keeps its size and key, its arrays must not be used
+for place in 1 2
+do
+	for byte in 377 200
+	do
+		randomize before$place$byte.log before.tsv -k 1
+		fromCache before$place$byte.log || fail "the cache was not used"
+		damage net.tsv.ctzcache $place $byte
+		randomize overwritten$place$byte.log overwritten.tsv -k 1
+		fromCache overwritten$place$byte.log && fail "a cache overwritten at $place/3 with \\$byte was used"
+		same grownref.tsv overwritten.tsv
+	done
+done
+
+exit 0
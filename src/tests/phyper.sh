@@ -0,0 +1,77 @@
+#phyper.sh: the p-hyper column of -p, from the genes each pair of groups shares, is the
+#hypergeometric probability of that overlap, with one thread or several, for one group
+#file and for the two group files of -a and -b.
+
+. "$(dirname "$0")/common.sh"
+
+#a network of the genes G1..G40 and groups overlapping by 0 to all of their genes
+awk 'BEGIN {for (i = 1; i <= 40; i++) for (j = i+1; j <= 40; j++) if ((i*j) % 7 < 3) printf "G%d\tG%d\t1\n", i, j}' > net.tsv
+group()
+{
+	name=$1
+	shift
+	for g in "$@"; do printf "G%d\t%s\n" $g $name; done
+}
+{
+	group A $(seq 1 10)
+	group B $(seq 6 17)
+	group C $(seq 21 30)
+	group D $(seq 1 10) 21 22 23
+	group E 3 8 13 18 23 28 33 38 40 39 37
+} > groups.tsv
+{
+	group A $(seq 1 10)
+	group B $(seq 6 17)
+} > groups1.tsv
+{
+	group C $(seq 21 30)
+	group F $(seq 5 16)
+	group G $(seq 30 40)
+} > groups2.tsv
+
+#check CSV GROUPFILES...: every p-hyper in CSV is C(m,k)C(N-m,n-k)/C(N,n) for the groups
+#of each pair, of sizes n <= m, sharing k genes, among the N genes of the group files
+check()
+{
+	csv=$1
+	shift
+	awk 'BEGIN {FS = "\t"}
+		function choose(a, b,   c, i) {
+			if (b < 0 || b > a) return 0
+			c = 1
+			for (i = 1; i <= b; i++) c = c*(a-b+i)/i
+			return c
+		}
+		FILENAME != csv {
+			if (!(($1) in all)) {all[$1] = 1; N++}
+			size[$2]++
+			member[$2, $1] = 1
+			genes[$2] = genes[$2] " " $1
+			next
+		}
+		$1 ~ /_vs_/ && $11 != "" && $11 != "NA" {
+			split($1, pair, "_vs_")
+			n = split(genes[pair[1]], list, " ")
+			k = 0
+			for (g = 1; g <= n; g++) if ((pair[2], list[g]) in member) k++
+			n = size[pair[1]] < size[pair[2]] ? size[pair[1]] : size[pair[2]]
+			m = size[pair[1]] < size[pair[2]] ? size[pair[2]] : size[pair[1]]
+			want = choose(m, k)*choose(N-m, n-k)/choose(N, n)
+			if ($11-want > 1e-9*want || want-$11 > 1e-9*want) {print $1 ": p-hyper " $11 ", want " want " for k = " k; bad = 1; exit}
+			checked++
+		}
+		END {if (bad) exit 1; if (checked < 3) {print "only " checked+0 " pairs checked"; exit 1}}' csv="$csv" "$@" "$csv" \
+		|| fail "wrong p-hyper in $csv"
+}
+
+for t in 1 4
+do
+	run all$t.log -n net.tsv -g groups.tsv -x 2 -d 3 -i 20 -S 7 -k 0 -K 0 -p 1 -t $t -o all$t.csv
+	check all$t.csv groups.tsv
+	run ab$t.log -n net.tsv -a groups1.tsv -b groups2.tsv -x 2 -d 3 -i 20 -S 7 -k 0 -K 0 -p 1 -t $t -o ab$t.csv
+	check ab$t.csv groups1.tsv groups2.tsv
+done
+same all1.csv all4.csv
+same ab1.csv ab4.csv
+
+exit 0
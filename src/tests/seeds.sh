@@ -0,0 +1,18 @@
+#seeds.sh: network i of -N n -S seed is the network of -S seed+i -N 1, for every
+#randomization method, and the networks of one run differ.
+
+. "$(dirname "$0")/common.sh"
+
+makeNetwork net.tsv 2000
+for method in 0 1 2 3
+do
+	run many$method.log -n net.tsv -g "$KEGG" -d $method -S 5 -N 3 -w many$method.tsv
+	for i in 0 1 2
+	do
+		run one$method$i.log -n net.tsv -g "$KEGG" -d $method -S $((5+i)) -N 1 -w one$method$i.tsv
+		same many${method}_$((i+1)).tsv one$method$i.tsv
+	done
+	cmp -s many${method}_1.tsv many${method}_2.tsv && fail "-d $method gave the same network for two seeds"
+done
+
+exit 0
@@ -0,0 +1,56 @@
+#tsvreader.sh: a TSV network read in several chunks, by several threads, compressed or
+#through -C gives the same network as a serial read, with links read twice and links
+#of a gene to itself.
+
+. "$(dirname "$0")/common.sh"
+
+#over TSV_MIN_CHUNK_BYTES per thread, so that -t 4 splits it
+makeNetwork links.tsv 200000 3
+#every 7th link again the other way round with another weight, every 11th gene also
+#linked to itself, after its first link, and every 13th link in lower case
+awk 'BEGIN {FS = OFS = "\t"}
+	{
+		if (NR % 13 == 0)
+			print tolower($1), $2, $3
+		else
+			print
+		if (NR % 7 == 0)
+			print $2, $1, (NR % 1000)/1000
+		if (NR % 11 == 0)
+			print $1, $1, $3
+	}' links.tsv > net.tsv
+[ $(wc -c < net.tsv) -gt 3000000 ] || fail "net.tsv is too small to be split"
+
+#the links and weights of a network, as the label swap keeps them all
+unique()
+{
+	awk 'BEGIN {FS = OFS = "\t"} {key = $1 < $2 ? $1 FS $2 : $2 FS $1; w[key] = $3+0} END {for (k in w) print k, w[k]}' "$1" | sort
+}
+
+run serial.log -n net.tsv -g "$KEGG" -d 3 -S 7 -k 0 -t 1 -w serial.tsv
+tr a-z A-Z < net.tsv > upper.tsv
+unique upper.tsv > want.txt
+unique serial.tsv > got.txt
+sort -t "	" -k3,3n want.txt | cut -f3 > wantweights.txt
+sort -t "	" -k3,3n got.txt | cut -f3 > gotweights.txt
+same wantweights.txt gotweights.txt
+
+run threads.log -n net.tsv -g "$KEGG" -d 3 -S 7 -k 0 -t 4 -w threads.tsv
+same serial.tsv threads.tsv
+
+gzip -c net.tsv > net.tsv.gz
+run gzip.log -n net.tsv.gz -g "$KEGG" -d 3 -S 7 -k 0 -t 4 -w gzip.tsv
+same serial.tsv gzip.tsv
+
+run columns.log -n net.tsv -g "$KEGG" -C 1,2,3 -d 3 -S 7 -k 0 -t 4 -w columns.tsv
+same serial.tsv columns.tsv
+
+#and an analysis, from the file and from its cache
+run analysis.log -n net.tsv -g "$KEGG" -i 2 -S 7 -k 1 -t 4 -o analysis.csv
+run serialanalysis.log -n net.tsv -g "$KEGG" -i 2 -S 7 -k 0 -t 1 -o serialanalysis.csv
+same serialanalysis.csv analysis.csv
+run cachedanalysis.log -n net.tsv -g "$KEGG" -i 2 -S 7 -k 1 -t 4 -o cachedanalysis.csv
+grep -q "Reading network from cache" cachedanalysis.log || fail "the cache was not used"
+same serialanalysis.csv cachedanalysis.csv
+
+exit 0
@@ -0,0 +1,59 @@
+#weights.sh: the networks written by -w keep the link weights of the network they were
+#randomized from, in TSV and XGMML, also when the network is loaded from its cache.
+
+. "$(dirname "$0")/common.sh"
+
+#weights NETWORK: the link weight of every gene pair of a TSV network, "GENE1<tab>GENE2<tab>WEIGHT"
+#with GENE1 < GENE2, the last weight of a pair read twice
+weights()
+{
+	awk 'BEGIN {FS = OFS = "\t"} {key = $1 < $2 ? $1 FS $2 : $2 FS $1; w[key] = $3+0} END {for (k in w) print k, w[k]}' "$1" | sort
+}
+
+#sorted weights of the links of a TSV or XGMML network, as numbers
+weightList()
+{
+	case "$1" in
+		*.xgmml) sed -n 's/.*weight="\([^"]*\)".*/\1/p' "$1";;
+		*) cut -f3 "$1";;
+	esac | awk '{print $1+0}' | sort -n
+}
+
+makeNetwork net.tsv
+weights net.tsv > orig.txt
+cut -f3 orig.txt | sort -n > origlist.txt
+
+#the label swap keeps every link with its weight, between other genes
+for out in labels.tsv labels.xgmml
+do
+	run $out.log -n net.tsv -g "$KEGG" -d 3 -S 7 -k 0 -w $out
+	weightList $out > list.txt
+	same origlist.txt list.txt
+done
+
+#a link that the other methods keep has its weight, a new link weight 1
+for method in 0 1 2
+do
+	run switch$method.log -n net.tsv -g "$KEGG" -d $method -S 7 -k 0 -w switch$method.tsv
+	weights switch$method.tsv > rand.txt
+	awk 'BEGIN {FS = "\t"} NR == FNR {w[$1 FS $2] = $3; next} {want = ($1 FS $2) in w ? w[$1 FS $2] : 1; if ($3 != want) {print; exit 1}}' orig.txt rand.txt \
+		|| fail "-d $method wrote a wrong weight"
+	awk 'BEGIN {FS = "\t"} $3 != 1 {n++} END {exit !n}' rand.txt || fail "-d $method kept no weights"
+done
+
+#the weights of an XGMML network are read too
+run reread.log -n labels.xgmml -g "$KEGG" -d 3 -S 7 -k 0 -w reread.tsv
+weightList reread.tsv > list.txt
+same origlist.txt list.txt
+
+#a cache written without the weights is not used by -w, one written with them is
+run analysis.log -n net.tsv -g "$KEGG" -i 1 -k 1 -o analysis.csv
+[ -e net.tsv.ctzcache ] || fail "no cache was written"
+run uncached.log -n net.tsv -g "$KEGG" -d 3 -S 7 -k 1 -w uncached.tsv
+grep -q "Reading network from cache" uncached.log && fail "-w used a cache without weights"
+run cached.log -n net.tsv -g "$KEGG" -d 3 -S 7 -k 1 -w cached.tsv
+grep -q "Reading network from cache" cached.log || fail "-w did not use its cache"
+same labels.tsv uncached.tsv
+same labels.tsv cached.tsv
+
+exit 0
@@ -0,0 +1,94 @@
+#xgmml.sh: an XGMML network gives the network of the TSV file of the same links, with
+#the attribute layouts Cytoscape and other tools write, and broken XGMML is refused.
+
+. "$(dirname "$0")/common.sh"
+
+#randomize LOG OUT ARGS...: one label swap network with seed 7 in OUT, with the link weights
+randomize()
+{
+	log=$1
+	out=$2
+	shift 2
+	run "$log" -g "$KEGG" -d 3 -S 7 -k 0 -w "$out" "$@"
+}
+
+makeNetwork links.tsv
+awk 'BEGIN {FS = "\t"} !(($1 FS $2) in seen) && !(($2 FS $1) in seen) && $1 != $2 {seen[$1 FS $2] = 1; print}' links.tsv > net.tsv
+
+#the nodes in the order of their first link, as the TSV reader numbers them, with lower case
+#labels, single quotes and child elements here and there; one edge before its nodes, an
+#isolated node and an edge to a node that is not declared, which are both left out
+awk 'BEGIN {FS = "\t"; q = "\047"}
+	function node(g) {
+		if (g in id) return
+		id[g] = ++n
+		if (n % 5 == 0)
+			nodes = nodes sprintf("  <node label=%s%s%s id=%s%d%s>\n    <att name=\"type\" value=\"gene\"/>\n  </node>\n", q, tolower(g), q, q, n, q)
+		else
+			nodes = nodes sprintf("  <node id=\"%d\" label=\"%s\"/>\n", n, g)
+	}
+	{
+		node($1)
+		node($2)
+		if (NR == 1)
+			first = sprintf("  <edge weight=\"%s\" target=\"%d\" source=\"%d\"/>\n", $3, id[$2], id[$1])
+		else if (NR % 7 == 0)
+			edges = edges sprintf("  <edge source=\"%d\" target=\"%d\" weight=\"%s\">\n    <att name=\"weight\" value=\"%s\"/>\n  </edge>\n", id[$1], id[$2], $3, $3)
+		else
+			edges = edges sprintf("  <edge source=\"%d\" target=\"%d\" weight=\"%s\"/>\n", id[$1], id[$2], $3)
+	}
+	END {
+		printf "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<!-- written by xgmml.sh -->\n"
+		printf "<graph label=\"test\" xmlns=\"http://www.cs.rpi.edu/XGMML\" directed=\"0\">\n"
+		printf "  <att name=\"documentVersion\" value=\"1.1\"/>\n"
+		printf "%s%s", first, nodes
+		printf "  <node id=\"isolated\" label=\"ISOLATED\"/>\n"
+		printf "  <edge source=\"1\" target=\"missing\" weight=\"1\"/>\n"
+		printf "%s</graph>\n", edges
+	}' net.tsv > net.xgmml
+
+randomize tsv.log tsv.tsv -n net.tsv
+randomize xgmml.log xgmml.tsv -n net.xgmml
+same tsv.tsv xgmml.tsv
+grep -q "ISOLATED\|MISSING" xgmml.tsv && fail "the isolated node or the undeclared one was kept"
+
+#a cutoff numbers the nodes of the TSV file by their first link that passes it, so only
+#the weights of the links are compared
+randomize tsvcut.log tsvcut.tsv -n net.tsv -c 0.5
+randomize xgmmlcut.log xgmmlcut.tsv -n net.xgmml -c 0.5
+cut -f3 tsvcut.tsv | sort -n > tsvcut.txt
+cut -f3 xgmmlcut.tsv | sort -n > xgmmlcut.txt
+same tsvcut.txt xgmmlcut.txt
+awk '$3 < 0.5 {exit 1}' xgmmlcut.tsv || fail "a link under the cutoff was read"
+
+#a network written as XGMML has the links and weights of the one written as TSV, and
+#reads back with them
+linkSet()
+{
+	case "$1" in
+		*.xgmml) awk 'BEGIN {OFS = "\t"}
+			function attr(name) {return match($0, name "=\"[^\"]*\"") ? substr($0, RSTART+length(name)+2, RLENGTH-length(name)-3) : ""}
+			/<node / {label[attr("id")] = attr("label")}
+			/<edge / {print label[attr("source")], label[attr("target")], attr("weight")}' "$1";;
+		*) cat "$1";;
+	esac | awk 'BEGIN {FS = OFS = "\t"} {print ($1 < $2 ? $1 FS $2 : $2 FS $1), $3+0}' | sort
+}
+
+randomize written.log written.xgmml -n net.tsv
+linkSet tsv.tsv > tsvlinks.txt
+linkSet written.xgmml > xgmmllinks.txt
+same tsvlinks.txt xgmmllinks.txt
+run reread.log -n written.xgmml -g "$KEGG" -d 3 -S 8 -k 0 -w reread.tsv
+cut -f3 tsvlinks.txt | sort -n > want.txt
+linkSet reread.tsv | cut -f3 | sort -n > got.txt
+same want.txt got.txt
+
+#broken files
+printf '<?xml version="1.0"?>\n<graph>\n  <node id="1" label="A"/>\n' > cut.xgmml
+"$BIN" -n cut.xgmml -g "$KEGG" -k 0 -o bad.csv > bad.log 2>&1 && fail "a truncated XGMML file was accepted"
+grep -q "Invalid XML file" bad.log || fail "no message for a truncated file:" "$(cat bad.log)"
+printf '<?xml version="1.0"?>\n<network>\n  <node id="1" label="A"/>\n</network>\n' > other.xgmml
+"$BIN" -n other.xgmml -g "$KEGG" -k 0 -o bad.csv > bad.log 2>&1 && fail "XML without a graph was accepted"
+grep -q "Invalid XGMML format" bad.log || fail "no message for XML without a graph:" "$(cat bad.log)"
+
+exit 0
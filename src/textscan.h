@@ -0,0 +1,241 @@
+/*
+CrossTalkZ - Statistical tool to assess crosstalk enrichment between node groupings in a network.
+Copyright (C) 2013  Ted McCormack
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Contents:
+This file contains the tokenizer kernel shared by the network and group file
+readers: scanField finds the end of a field, the first of up to four
+delimiter bytes, and notes in the same pass whether the field has lower case
+ASCII letters, splitFields splits a line into its non-empty fields and
+upperCopy upper cases ASCII. On x86 the kernels compare 32 bytes at a time
+with AVX2 if the CPU has it, chosen once at run time, and 16 bytes at a
+time with SSE2 otherwise. Other CPUs use the scalar versions.
+
+*/
+
+#ifndef __TEXTSCAN_H__
+#define __TEXTSCAN_H__
+
+#include <string.h>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define TEXTSCAN_X86	1
+#else
+	#define TEXTSCAN_X86	0
+#endif
+
+#include "mappedfile.h"
+
+using namespace std;
+
+//up to four delimiter bytes, unused entries repeat the first one
+struct DelimiterSet
+{
+	DelimiterSet(char a){c[0] = c[1] = c[2] = c[3] = a;}
+	DelimiterSet(char a, char b){c[0] = c[2] = c[3] = a; c[1] = b;}
+	DelimiterSet(char a, char b, char d){c[0] = c[3] = a; c[1] = b; c[2] = d;}
+	DelimiterSet(char a, char b, char d, char e){c[0] = a; c[1] = b; c[2] = d; c[3] = e;}
+
+	bool contains(char x) const
+	{
+		return x == c[0] || x == c[1] || x == c[2] || x == c[3];
+	}
+
+	char c[4];
+};
+
+inline bool isLowerASCII(char x)
+{
+	return (unsigned char)(x-'a') < 26;
+}
+
+inline char toUpperASCII(char x)
+{
+	return isLowerASCII(x) ? x-('a'-'A') : x;
+}
+
+/* scalar kernels, also used for the bytes after the last whole vector */
+
+inline const char* scanFieldScalar(const char *p, const char *end, const DelimiterSet &d, bool &lower)
+{
+	for (; p != end && !d.contains(*p); p++)
+		lower |= isLowerASCII(*p);
+	return p;
+}
+
+inline void upperCopyScalar(char *dst, const char *src, size_t n)
+{
+	for (size_t k = 0; k < n; k++)
+		dst[k] = toUpperASCII(src[k]);
+}
+
+#if TEXTSCAN_X86
+
+//the bytes of x that are 'a'..'z': x-'a' < 26 as a signed compare after moving 'a' to -128
+#define LOWER_MASK_128(x)	_mm_cmplt_epi8(_mm_add_epi8((x), _mm_set1_epi8((char)(128-'a'))), _mm_set1_epi8((char)(-128+26)))
+#define LOWER_MASK_256(x)	_mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128+26)), _mm256_add_epi8((x), _mm256_set1_epi8((char)(128-'a'))))
+
+inline const char* scanFieldSSE2(const char *p, const char *end, const DelimiterSet &d, bool &lower)
+{
+	const __m128i d0 = _mm_set1_epi8(d.c[0]), d1 = _mm_set1_epi8(d.c[1]), d2 = _mm_set1_epi8(d.c[2]), d3 = _mm_set1_epi8(d.c[3]);
+	__m128i x, hit;
+	unsigned int bits, low;
+
+	for (; end-p >= 16; p += 16)
+	{
+		x = _mm_loadu_si128((const __m128i*)p);
+		hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, d0), _mm_cmpeq_epi8(x, d1)), _mm_or_si128(_mm_cmpeq_epi8(x, d2), _mm_cmpeq_epi8(x, d3)));
+		bits = _mm_movemask_epi8(hit);
+		low = _mm_movemask_epi8(LOWER_MASK_128(x));
+		if (bits)
+		{
+			//only the letters before the delimiter count
+			lower |= (low & (bits ^ (bits-1)) & ~bits) != 0;
+			return p + __builtin_ctz(bits);
+		}
+		lower |= (low != 0);
+	}
+	return scanFieldScalar(p, end, d, lower);
+}
+
+inline void upperCopySSE2(char *dst, const char *src, size_t n)
+{
+	__m128i x;
+	size_t k;
+
+	for (k = 0; k+16 <= n; k += 16)
+	{
+		x = _mm_loadu_si128((const __m128i*)(src+k));
+		x = _mm_sub_epi8(x, _mm_and_si128(LOWER_MASK_128(x), _mm_set1_epi8(0x20)));
+		_mm_storeu_si128((__m128i*)(dst+k), x);
+	}
+	upperCopyScalar(dst+k, src+k, n-k);
+}
+
+__attribute__((target("avx2")))
+inline const char* scanFieldAVX2(const char *p, const char *end, const DelimiterSet &d, bool &lower)
+{
+	const __m256i d0 = _mm256_set1_epi8(d.c[0]), d1 = _mm256_set1_epi8(d.c[1]), d2 = _mm256_set1_epi8(d.c[2]), d3 = _mm256_set1_epi8(d.c[3]);
+	__m256i x, hit;
+	unsigned int bits, low;
+
+	for (; end-p >= 32; p += 32)
+	{
+		x = _mm256_loadu_si256((const __m256i*)p);
+		hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, d0), _mm256_cmpeq_epi8(x, d1)), _mm256_or_si256(_mm256_cmpeq_epi8(x, d2), _mm256_cmpeq_epi8(x, d3)));
+		bits = _mm256_movemask_epi8(hit);
+		low = _mm256_movemask_epi8(LOWER_MASK_256(x));
+		if (bits)
+		{
+			lower |= (low & (bits ^ (bits-1)) & ~bits) != 0;
+			return p + __builtin_ctz(bits);
+		}
+		lower |= (low != 0);
+	}
+	return scanFieldSSE2(p, end, d, lower);
+}
+
+__attribute__((target("avx2")))
+inline void upperCopyAVX2(char *dst, const char *src, size_t n)
+{
+	__m256i x;
+	size_t k;
+
+	for (k = 0; k+32 <= n; k += 32)
+	{
+		x = _mm256_loadu_si256((const __m256i*)(src+k));
+		x = _mm256_sub_epi8(x, _mm256_and_si256(LOWER_MASK_256(x), _mm256_set1_epi8(0x20)));
+		_mm256_storeu_si256((__m256i*)(dst+k), x);
+	}
+	upperCopySSE2(dst+k, src+k, n-k);
+}
+
+//true if the CPU runs AVX2, asked once
+inline bool hasAVX2()
+{
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	return avx2;
+}
+
+#endif
+
+//scanField:
+//	Returns the first byte in [p, end) that is in d, or end, and sets lower
+//	if a byte before it is a lower case ASCII letter. lower is never cleared.
+inline const char* scanField(const char *p, const char *end, const DelimiterSet &d, bool &lower)
+{
+#if TEXTSCAN_X86
+	if (hasAVX2())
+		return scanFieldAVX2(p, end, d, lower);
+	return scanFieldSSE2(p, end, d, lower);
+#else
+	return scanFieldScalar(p, end, d, lower);
+#endif
+}
+
+inline const char* scanField(const char *p, const char *end, const DelimiterSet &d)
+{
+	bool lower = false;
+	return scanField(p, end, d, lower);
+}
+
+//upperCopy: sets out to the n bytes at s with ASCII letters upper cased
+inline void upperCopy(const char *s, size_t n, string &out)
+{
+	out.resize(n);
+	if (!n)
+		return;
+#if TEXTSCAN_X86
+	if (hasAVX2())
+		upperCopyAVX2(&out[0], s, n);
+	else
+		upperCopySSE2(&out[0], s, n);
+#else
+	upperCopyScalar(&out[0], s, n);
+#endif
+}
+
+inline void upperCopy(const TextSlice &s, string &out)
+{
+	upperCopy(s.first, s.size(), out);
+}
+
+//splitFields:
+//	Sets fields to the non-empty fields of line between runs of the bytes in d
+//	and returns their number.
+inline int splitFields(TextSlice line, const DelimiterSet &d, vector<TextSlice> &fields)
+{
+	const char *p = line.first, *fieldEnd;
+
+	fields.clear();
+	while (p != line.last)
+	{
+		fieldEnd = scanField(p, line.last, d);
+		if (fieldEnd != p)
+			fields.push_back(TextSlice(p, fieldEnd));
+		p = (fieldEnd == line.last) ? fieldEnd : fieldEnd+1;
+	}
+	return (int)fields.size();
+}
+
+inline int splitFields(const string &line, const DelimiterSet &d, vector<TextSlice> &fields)
+{
+	return splitFields(TextSlice(line.data(), line.data()+line.size()), d, fields);
+}
+
+#endif
@@ -23,7 +23,10 @@ Various type definitions used throughout the CrossTalkZ program.
 #ifndef __TYPES_H__
 #define __TYPES_H__
 
+#include <stdint.h>
+#include <boost/unordered_map.hpp>
 #include "boostgraph.h"
+#include "symboltable.h"
 
 using namespace boost;
 using namespace std;
@@ -32,23 +35,17 @@ using namespace std;
 class NodeProperties 
 {
 	public:
-		NodeProperties(){}
+		NodeProperties(){geneId = SymbolTable::NONE;}
 		~NodeProperties(){}
 	
-		string geneId;
-		vector<int> connectedDegrees;
+		SymbolTable::Symbol geneId;	//symbol in geneSymbols
 };
 
-class LinkProperties 
-{
-	public:
-		LinkProperties(){}
-		~LinkProperties(){}
-	
-		float weight;
-};
-
-typedef BoostGraph<NodeProperties, LinkProperties> Graph;
+//The loaded Graph is the unweighted BoostGraph specialization. Link weights are only used while
+//a network is read, for the cutoff, and by the networks written with -w. Only then, when
+//keepLinkWeights is set, the reader keeps them beside the graph, by node pair.
+typedef BoostGraph<NodeProperties, no_property> Graph;
+typedef boost::unordered_map<pair<Graph::Node, Graph::Node>, float> LinkWeights;
 
 class GeneGroup
 {
@@ -56,24 +53,54 @@ class GeneGroup
 		GeneGroup(){}
 		~GeneGroup(){}
 	
-		string groupId;
+		SymbolTable::Symbol groupId;	//symbol in groupSymbols
 		string groupSpe;
 		string groupSys;
 		string groupDesc;
-		vector<string> groupGenes;
+		vector<SymbolTable::Symbol> groupGenes;	//symbols in geneSymbols
 		
 		string inputFilePath;
 		
-		GeneGroup &operator=(const GeneGroup &rhs)
-		{	
-			this->groupId = rhs.groupId;
-			this->groupSpe = rhs.groupSpe;
-			this->groupSys = rhs.groupSys;
-			this->groupDesc = rhs.groupDesc;
-			this->groupGenes = rhs.groupGenes;
-			this->inputFilePath = rhs.inputFilePath;
-			
-			return *this;
+		//member wise, moving a group moves its strings and genes instead of copying them
+		GeneGroup(const GeneGroup&) = default;
+		GeneGroup(GeneGroup&&) = default;
+		GeneGroup& operator=(const GeneGroup&) = default;
+		GeneGroup& operator=(GeneGroup&&) = default;
+};
+
+
+//GeneGroupMap:
+//	The group membership of the network's nodes as loaded by readGeneGroups, in CSR form: the
+//	groups of node v are the indexes into its vector<GeneGroup> at [offsets[v], offsets[v+1])
+//	in narrowIds, or in wideIds for collections of more than NARROW_GROUP_IDS groups. The
+//	indexes of a node are ascending, a gene listed twice in a group has its index twice.
+#define NARROW_GROUP_IDS	65536 //groups that fit a uint16_t index
+
+class GeneGroupMap
+{
+	public:
+		GeneGroupMap(){narrow = true;}
+		~GeneGroupMap(){}
+		
+		vector<uint32_t> offsets;	//node id -> first entry of the node, node count + 1 entries
+		vector<uint16_t> narrowIds;	//group indexes if narrow
+		vector<uint32_t> wideIds;	//group indexes if not narrow
+		bool narrow;
+		vector<int> groupIndex;	//group symbol -> index of the group in its vector<GeneGroup>, -1 if not loaded
+		
+		//the number of groups of node v
+		int getGroupCount(uint32_t v) const
+		{
+			return offsets[v+1]-offsets[v];
+		}
+		
+		void clear()
+		{
+			offsets.clear();
+			narrowIds.clear();
+			wideIds.clear();
+			narrow = true;
+			groupIndex.clear();
 		}
 };
 
@@ -119,7 +146,7 @@ class Stats
 
 struct Record
 {
-	Graph::Node node;
+	uint32_t node;	//CSRGraph node id
 	int degree;
 	//int smetric;
 };